@@ -0,0 +1,237 @@
+#include "AnomalyDetector.h"
+#include "LocalDate.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+using json = nlohmann::json;
+
+namespace {
+
+// Entries closer together than this still move the running mean a little
+const double kMinStepDays = 1.0 / 24.0;
+
+// Format a number with at most one decimal place
+std::string formatScore(double value) {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(value == std::round(value) ? 0 : 1) << value;
+    return ss.str();
+}
+
+// Rule types as written in rule files
+const std::pair<const char*, AlertRuleType> kRuleTypeNames[] = {
+    {"lowStreak", AlertRuleType::LowStreak},
+    {"dropBelowMean", AlertRuleType::DropBelowMean},
+    {"moodSwing", AlertRuleType::MoodSwing}
+};
+
+} // namespace
+
+// Start with the default rules
+AnomalyDetector::AnomalyDetector() {
+    initializeDefaultRules();
+}
+
+// Initialize with the default rules
+void AnomalyDetector::initializeDefaultRules() {
+    setRules({
+        // Mood at 3 or lower for 5 days running
+        {AlertRuleType::LowStreak, "low-streak", 3, 5, 0.0, 0, true},
+        // A score 4+ points below the ~14-day average, once there's an average to speak of
+        {AlertRuleType::DropBelowMean, "sudden-drop", 4, 14, 0.0, 5, false},
+        // A 6+ point swing within 3 days
+        {AlertRuleType::MoodSwing, "mood-swing", 6, 3, 0.0, 0, false}
+    });
+}
+
+// Replace the rules (clears all running state)
+void AnomalyDetector::setRules(const std::vector<AlertRule>& newRules) {
+    rules = newRules;
+    reset();
+}
+
+// Load rules from a JSON file, replacing the current ones
+bool AnomalyDetector::loadRulesFromFile(const std::string& filename) {
+    try {
+        // Open the file
+        std::ifstream inFile(filename);
+        if (!inFile.is_open()) {
+            return false;
+        }
+
+        // Parse JSON
+        json rulesJson;
+        inFile >> rulesJson;
+
+        std::vector<AlertRule> loaded;
+        for (const auto& ruleJson : rulesJson.at("rules")) {
+            std::string typeName = ruleJson.at("type");
+            auto type = std::find_if(std::begin(kRuleTypeNames), std::end(kRuleTypeNames),
+                                     [&typeName](const auto& entry) { return typeName == entry.first; });
+            if (type == std::end(kRuleTypeNames)) {
+                return false;
+            }
+
+            AlertRule rule{type->second, ruleJson.value("name", typeName),
+                           ruleJson.at("threshold").get<double>(), ruleJson.at("days").get<int>()};
+            rule.minSigmas = ruleJson.value("minSigmas", 0.0);
+            rule.warmupEntries = ruleJson.value("warmupEntries", 0);
+            rule.crisis = ruleJson.value("crisis", false);
+            if (rule.days < 1) {
+                return false;
+            }
+            loaded.push_back(rule);
+        }
+
+        setRules(loaded);
+        return true;
+    } catch (...) {
+        // Keep the current rules in case of errors
+        return false;
+    }
+}
+
+// Get the configured rules
+const std::vector<AlertRule>& AnomalyDetector::getRules() const {
+    return rules;
+}
+
+// Forget everything observed so far, keeping the rules
+void AnomalyDetector::reset() {
+    states.assign(rules.size(), RuleState());
+    lastTime = std::chrono::system_clock::time_point();
+    entriesSeen = 0;
+}
+
+// Feed one entry and return the alerts it triggered
+std::vector<MoodAlert> AnomalyDetector::observe(int score,
+                                                const std::chrono::system_clock::time_point& timestamp) {
+    std::vector<MoodAlert> alerts;
+
+    // Out-of-order entries are treated as arriving at the same moment
+    double elapsedDays = 0.0;
+    if (entriesSeen > 0 && timestamp > lastTime) {
+        elapsedDays = std::chrono::duration<double, std::ratio<86400>>(timestamp - lastTime).count();
+    }
+    long long day = localDayNumber(timestamp);
+
+    for (size_t i = 0; i < rules.size(); ++i) {
+        const AlertRule& rule = rules[i];
+        RuleState& state = states[i];
+        std::string message;
+        bool holds = false;
+
+        switch (rule.type) {
+            case AlertRuleType::LowStreak:
+                holds = updateLowStreak(rule, state, score, day);
+                message = "Your mood has been " + formatScore(rule.threshold) + " or lower for " +
+                          std::to_string(rule.days) + " days in a row.";
+                break;
+            case AlertRuleType::DropBelowMean:
+                holds = updateDropBelowMean(rule, state, score, elapsedDays, message);
+                break;
+            case AlertRuleType::MoodSwing:
+                holds = updateMoodSwing(rule, state, score, timestamp, message);
+                break;
+        }
+
+        // Fire on the transition into the condition, after the warm-up
+        if (holds && !state.firing && entriesSeen >= static_cast<size_t>(rule.warmupEntries)) {
+            alerts.push_back({rule.name, message, rule.crisis});
+        }
+        state.firing = holds;
+    }
+
+    ++entriesSeen;
+    lastTime = std::max(lastTime, timestamp);
+    return alerts;
+}
+
+// Count consecutive days whose every entry is at or below the threshold
+bool AnomalyDetector::updateLowStreak(const AlertRule& rule, RuleState& state, int score, long long day) {
+    bool low = score <= rule.threshold;
+
+    if (entriesSeen == 0 || day > state.currentDay) {
+        // A new day extends the streak only if it directly follows a qualifying one
+        if (entriesSeen > 0 && state.dayQualifies && day == state.currentDay + 1) {
+            ++state.completedDays;
+        } else {
+            state.completedDays = 0;
+        }
+        state.currentDay = day;
+        state.dayQualifies = low;
+    } else if (day == state.currentDay) {
+        state.dayQualifies = state.dayQualifies && low;
+    }
+    // Entries for days already closed don't change the streak
+
+    int streak = state.completedDays + (state.dayQualifies ? 1 : 0);
+    return state.dayQualifies && streak >= rule.days;
+}
+
+// Compare against a time-decayed mean, then fold the score into it
+bool AnomalyDetector::updateDropBelowMean(const AlertRule& rule, RuleState& state, int score,
+                                          double elapsedDays, std::string& message) {
+    if (entriesSeen == 0) {
+        state.mean = score;
+        state.variance = 0.0;
+        return false;
+    }
+
+    double drop = state.mean - score;
+    double deviation = std::sqrt(state.variance);
+    bool holds = drop >= rule.threshold &&
+                 (rule.minSigmas <= 0.0 || (deviation > 0.0 && drop >= rule.minSigmas * deviation));
+    if (holds) {
+        message = "Your score of " + std::to_string(score) + " is " + formatScore(drop) +
+                  " points below your recent average of " + formatScore(state.mean) + ".";
+    }
+
+    // Exponentially weighted mean and variance with a time constant of rule.days
+    double alpha = 1.0 - std::exp(-std::max(elapsedDays, kMinStepDays) / rule.days);
+    double diff = score - state.mean;
+    double increment = alpha * diff;
+    state.mean += increment;
+    state.variance = (1.0 - alpha) * (state.variance + diff * increment);
+
+    return holds;
+}
+
+// Track the window's extremes with monotonic deques
+bool AnomalyDetector::updateMoodSwing(const AlertRule& rule, RuleState& state, int score,
+                                      const std::chrono::system_clock::time_point& time,
+                                      std::string& message) {
+    // Older entries that are no larger (smaller) can never be the window max (min)
+    while (!state.maxQueue.empty() && state.maxQueue.back().second <= score) {
+        state.maxQueue.pop_back();
+    }
+    state.maxQueue.emplace_back(time, score);
+    while (!state.minQueue.empty() && state.minQueue.back().second >= score) {
+        state.minQueue.pop_back();
+    }
+    state.minQueue.emplace_back(time, score);
+
+    // Drop entries that have left the window
+    auto windowStart = std::max(lastTime, time) - std::chrono::hours(24 * rule.days);
+    while (!state.maxQueue.empty() && state.maxQueue.front().first <= windowStart) {
+        state.maxQueue.pop_front();
+    }
+    while (!state.minQueue.empty() && state.minQueue.front().first <= windowStart) {
+        state.minQueue.pop_front();
+    }
+    if (state.maxQueue.empty() || state.minQueue.empty()) {
+        // Only happens for an entry older than the whole window
+        return false;
+    }
+
+    int swing = state.maxQueue.front().second - state.minQueue.front().second;
+    if (swing >= rule.threshold) {
+        message = "Your mood has swung by " + std::to_string(swing) + " points over the last " +
+                  std::to_string(rule.days) + " days.";
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,97 @@
+#ifndef ANOMALY_DETECTOR_H
+#define ANOMALY_DETECTOR_H
+
+#include <chrono>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Kinds of pattern an alert rule can watch for
+enum class AlertRuleType {
+    LowStreak,          // Score at or below threshold on `days` consecutive days
+    DropBelowMean,      // Score at least threshold points below the recent average
+    MoodSwing           // Highest minus lowest score within `days` reaches threshold
+};
+
+// Configuration for one alert rule
+struct AlertRule {
+    AlertRuleType type;
+    std::string name;           // Short identifier, e.g. "low-streak"
+    double threshold;           // Score, point drop or swing size (see AlertRuleType)
+    int days;                   // Streak length, averaging horizon or swing window
+    double minSigmas = 0.0;     // DropBelowMean: also require this many std devs (0 = off)
+    int warmupEntries = 0;      // Entries to observe before the rule may fire
+    bool crisis = false;        // Whether firing should surface crisis resources
+};
+
+// An alert raised by a rule when an entry arrives
+struct MoodAlert {
+    std::string ruleName;       // Name of the rule that fired
+    std::string message;        // Human-readable explanation
+    bool crisis;                // Whether crisis resources should be shown
+};
+
+// Watches a stream of mood scores and raises alerts as entries arrive.
+//
+// Every rule keeps a small running state instead of rescanning the history:
+// streak counters for LowStreak, a time-decayed mean and variance (EWMA) for
+// DropBelowMean, and monotonic deques of the window's candidate extremes for
+// MoodSwing. A rule fires once when its condition starts to hold and re-arms
+// after the condition clears.
+class AnomalyDetector {
+private:
+    // Running state for one rule
+    struct RuleState {
+        // LowStreak
+        long long currentDay = 0;
+        bool dayQualifies = false;
+        int completedDays = 0;          // Qualifying consecutive days before currentDay
+
+        // DropBelowMean
+        double mean = 0.0;
+        double variance = 0.0;
+
+        // MoodSwing: (time, score) with scores decreasing / increasing
+        std::deque<std::pair<std::chrono::system_clock::time_point, int>> maxQueue;
+        std::deque<std::pair<std::chrono::system_clock::time_point, int>> minQueue;
+
+        bool firing = false;            // Condition held on the previous entry
+    };
+
+    std::vector<AlertRule> rules;
+    std::vector<RuleState> states;
+    std::chrono::system_clock::time_point lastTime;
+    size_t entriesSeen = 0;
+
+    // Update one rule with a new score; true if its condition holds now
+    bool updateLowStreak(const AlertRule& rule, RuleState& state, int score, long long day);
+    bool updateDropBelowMean(const AlertRule& rule, RuleState& state, int score, double elapsedDays,
+                             std::string& message);
+    bool updateMoodSwing(const AlertRule& rule, RuleState& state, int score,
+                         const std::chrono::system_clock::time_point& time, std::string& message);
+
+public:
+    // Start with the default rules
+    AnomalyDetector();
+
+    // Initialize with the default rules
+    void initializeDefaultRules();
+
+    // Replace the rules (clears all running state)
+    void setRules(const std::vector<AlertRule>& newRules);
+
+    // Load rules from a JSON file, replacing the current ones
+    bool loadRulesFromFile(const std::string& filename);
+
+    // Get the configured rules
+    const std::vector<AlertRule>& getRules() const;
+
+    // Forget everything observed so far, keeping the rules
+    void reset();
+
+    // Feed one entry and return the alerts it triggered
+    std::vector<MoodAlert> observe(int score, const std::chrono::system_clock::time_point& timestamp);
+};
+
+#endif // ANOMALY_DETECTOR_H
@@ -0,0 +1,357 @@
+#include "Commands.h"
+#include "MoodHistoryFile.h"
+#include "HistoryMerger.h"
+#include "ResourceMap.h"
+#include "LocalDate.h"
+#include "MoodTracker.h"
+#include <nlohmann/json.hpp>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace {
+
+const char* const kDefaultHistoryFile = "data/mood_history.json";
+const char* const kResourceFile = "resources/empathylinks.json";
+
+// Print a short summary of every subcommand
+void printUsage() {
+    std::cerr << "Usage:" << std::endl;
+    std::cerr << "  EmpathyCLI                      Start the interactive menu" << std::endl;
+    std::cerr << "  EmpathyCLI log SCORE WORDS...   Record a mood (score 1-10)" << std::endl;
+    std::cerr << "  EmpathyCLI stats [--json]       Show mood statistics" << std::endl;
+    std::cerr << "  EmpathyCLI resources [--mood WORD] [--score N] [--json]" << std::endl;
+    std::cerr << "  EmpathyCLI merge -o OUTPUT [--memory-mb N] [--spill-dir DIR] FILE..." << std::endl;
+    std::cerr << "log and stats accept --history FILE (default " << kDefaultHistoryFile << ")." << std::endl;
+}
+
+// Parse a whole argument as an integer
+bool parseInt(const std::string& text, int& value) {
+    try {
+        size_t used = 0;
+        value = std::stoi(text, &used);
+        return used == text.size();
+    } catch (...) {
+        return false;
+    }
+}
+
+// Whether two paths name the same existing file
+bool sameFile(const std::string& a, const std::string& b) {
+    std::error_code ec;
+    return fs::equivalent(a, b, ec);
+}
+
+// JSON form of a resource
+json resourceToJson(const Resource& resource) {
+    return {
+        {"title", resource.title},
+        {"url", resource.url},
+        {"description", resource.description}
+    };
+}
+
+} // namespace
+
+// Run the subcommand named by args[0]; returns the process exit code
+int runCommand(const std::vector<std::string>& args) {
+    const std::string& name = args[0];
+    if (name == "log") return runLogCommand(args);
+    if (name == "stats") return runStatsCommand(args);
+    if (name == "resources") return runResourcesCommand(args);
+    if (name == "merge") return runMergeCommand(args);
+
+    printUsage();
+    return name == "help" || name == "--help" || name == "-h" ? 0 : 1;
+}
+
+// Record a mood by appending to the history file, without reading it
+int runLogCommand(const std::vector<std::string>& args) {
+    std::string historyFile = kDefaultHistoryFile;
+    std::vector<std::string> positional;
+
+    for (size_t i = 1; i < args.size(); ++i) {
+        if (args[i] == "--history" && i + 1 < args.size()) {
+            historyFile = args[++i];
+        } else {
+            positional.push_back(args[i]);
+        }
+    }
+
+    int score = 0;
+    if (positional.empty() || !parseInt(positional[0], score) || score < 1 || score > 10) {
+        std::cerr << "Usage: EmpathyCLI log SCORE DESCRIPTION... (SCORE between 1 and 10)" << std::endl;
+        return 1;
+    }
+
+    // The rest of the arguments form the description
+    std::string description;
+    for (size_t i = 1; i < positional.size(); ++i) {
+        if (i > 1) {
+            description += ' ';
+        }
+        description += positional[i];
+    }
+
+    // Create the data directory if it doesn't exist
+    std::error_code ec;
+    fs::path parent = fs::path(historyFile).parent_path();
+    if (!parent.empty()) {
+        fs::create_directories(parent, ec);
+    }
+
+    // An interactive session or another log may be writing the same file
+    HistoryFileLock lock(historyFile);
+    MoodRecord record = MoodRecord::fromEntry(MoodEntry(score, description));
+    if (!lock.locked() || !appendMoodRecord(historyFile, record)) {
+        std::cerr << "Could not write to " << historyFile << "." << std::endl;
+        return 1;
+    }
+
+    std::cout << "Mood logged at " << record.timestamp << ": " << score << "/10" << std::endl;
+    return 0;
+}
+
+// Show statistics by streaming the history file
+int runStatsCommand(const std::vector<std::string>& args) {
+    std::string historyFile = kDefaultHistoryFile;
+    bool asJson = false;
+
+    for (size_t i = 1; i < args.size(); ++i) {
+        if (args[i] == "--json") {
+            asJson = true;
+        } else if (args[i] == "--history" && i + 1 < args.size()) {
+            historyFile = args[++i];
+        } else {
+            std::cerr << "Usage: EmpathyCLI stats [--json] [--history FILE]" << std::endl;
+            return 1;
+        }
+    }
+
+    // Keep writers out until both files have been read
+    HistoryFileLock lock(historyFile, false);
+    
+    // Single pass; highest and lowest keep their first occurrence
+    size_t count = 0;
+    long long sum = 0;
+    MoodRecord highest;
+    MoodRecord lowest;
+    std::string first;
+    std::string last;
+
+    // Rolled-up (older) entries come first, dated by the day or week they start
+    std::string rollupFile = MoodTracker::rollupFileFor(historyFile);
+    if (fs::exists(rollupFile)) {
+        std::vector<MoodRollup> daily;
+        std::vector<MoodRollup> weekly;
+        if (!MoodTracker::parseRollups(rollupFile, daily, weekly)) {
+            std::cerr << "Could not read " << rollupFile << "." << std::endl;
+            return 1;
+        }
+        for (const auto* tier : {&weekly, &daily}) {
+            for (const auto& rollup : *tier) {
+                std::string start = formatDayNumber(rollup.startDay) + " 00:00:00";
+                if (count == 0 || rollup.highest > highest.score) highest = {start, rollup.highest, ""};
+                if (count == 0 || rollup.lowest < lowest.score) lowest = {start, rollup.lowest, ""};
+                if (count == 0 || start < first) first = start;
+                if (count == 0 || start > last) last = start;
+                sum += rollup.sum;
+                count += rollup.count;
+            }
+        }
+    }
+
+    if (fs::exists(historyFile)) {
+        MoodHistoryReader reader(historyFile);
+        MoodRecord record;
+        while (reader.next(record)) {
+            if (count == 0 || record.score > highest.score) highest = record;
+            if (count == 0 || record.score < lowest.score) lowest = record;
+            if (count == 0 || record.timestamp < first) first = record.timestamp;
+            if (count == 0 || record.timestamp > last) last = record.timestamp;
+            sum += record.score;
+            ++count;
+        }
+        if (!reader.good()) {
+            std::cerr << "Could not read " << historyFile << "." << std::endl;
+            return 1;
+        }
+    }
+
+    double average = count > 0 ? static_cast<double>(sum) / count : 0.0;
+
+    if (asJson) {
+        json statsJson = {{"entries", count}};
+        if (count > 0) {
+            statsJson["average"] = average;
+            statsJson["highest"] = {{"score", highest.score}, {"timestamp", highest.timestamp}};
+            statsJson["lowest"] = {{"score", lowest.score}, {"timestamp", lowest.timestamp}};
+            statsJson["first"] = first;
+            statsJson["last"] = last;
+        }
+        std::cout << statsJson.dump(4) << std::endl;
+    } else if (count == 0) {
+        std::cout << "No mood entries found." << std::endl;
+    } else {
+        std::cout << "Total entries: " << count << std::endl;
+        std::cout << "Average mood score: " << std::fixed << std::setprecision(1) << average << "/10" << std::endl;
+        std::cout << "Highest mood: " << highest.score << "/10 on " << highest.timestamp << std::endl;
+        std::cout << "Lowest mood: " << lowest.score << "/10 on " << lowest.timestamp << std::endl;
+    }
+    return 0;
+}
+
+// List resources for moods or scores, without touching the history
+int runResourcesCommand(const std::vector<std::string>& args) {
+    std::vector<std::string> moods;
+    std::vector<int> scores;
+    bool asJson = false;
+
+    for (size_t i = 1; i < args.size(); ++i) {
+        int score = 0;
+        if (args[i] == "--json") {
+            asJson = true;
+        } else if (args[i] == "--mood" && i + 1 < args.size()) {
+            moods.push_back(args[++i]);
+        } else if (args[i] == "--score" && i + 1 < args.size() && parseInt(args[i + 1], score)) {
+            scores.push_back(score);
+            ++i;
+        } else {
+            std::cerr << "Usage: EmpathyCLI resources [--mood WORD] [--score N] [--json]" << std::endl;
+            return 1;
+        }
+    }
+
+    ResourceMap resources;
+    if (fs::exists(kResourceFile)) {
+        resources.loadResourcesFromFile(kResourceFile);
+    }
+
+    // Without filters, list everything by mood
+    if (moods.empty() && scores.empty()) {
+        for (const auto& [mood, moodResources] : resources.getAllMoodResources()) {
+            moods.push_back(mood);
+        }
+    }
+
+    // Gather the selection, skipping resources already listed
+    std::vector<std::pair<std::string, Resource>> selected;
+    auto addResources = [&selected](const std::string& label, const std::vector<Resource>& found) {
+        for (const auto& resource : found) {
+            bool seen = std::any_of(selected.begin(), selected.end(),
+                                    [&resource](const auto& entry) { return entry.second.url == resource.url; });
+            if (!seen) {
+                selected.emplace_back(label, resource);
+            }
+        }
+    };
+    for (const auto& mood : moods) {
+        addResources(mood, resources.getResourcesForMood(mood));
+    }
+    for (int score : scores) {
+        addResources("score " + std::to_string(score), resources.getResourcesForScore(score));
+    }
+
+    if (asJson) {
+        json resourcesJson = json::array();
+        for (const auto& [label, resource] : selected) {
+            json resourceJson = resourceToJson(resource);
+            resourceJson["for"] = label;
+            resourcesJson.push_back(resourceJson);
+        }
+        std::cout << resourcesJson.dump(4) << std::endl;
+    } else if (selected.empty()) {
+        std::cout << "No resources found." << std::endl;
+    } else {
+        for (const auto& [label, resource] : selected) {
+            std::cout << "- " << resource.title << " (" << label << ")" << std::endl;
+            std::cout << "  " << resource.description << std::endl;
+            std::cout << "  URL: " << resource.url << std::endl;
+        }
+    }
+    return 0;
+}
+
+// Merge several mood history files into one
+int runMergeCommand(const std::vector<std::string>& args) {
+    std::string output;
+    std::string spillDirectory;
+    size_t memoryMb = 64;
+    std::vector<std::string> inputs;
+    
+    // Parse options; everything else is an input file
+    for (size_t i = 1; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        bool hasValue = i + 1 < args.size();
+        
+        if ((arg == "-o" || arg == "--output") && hasValue) {
+            output = args[++i];
+        } else if (arg == "--memory-mb" && hasValue) {
+            try {
+                memoryMb = std::stoul(args[++i]);
+            } catch (...) {
+                memoryMb = 0;
+            }
+            if (memoryMb == 0) {
+                std::cerr << "Invalid value for --memory-mb." << std::endl;
+                return 1;
+            }
+        } else if (arg == "--spill-dir" && hasValue) {
+            spillDirectory = args[++i];
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+    
+    if (inputs.empty() || output.empty()) {
+        std::cerr << "Usage: EmpathyCLI merge -o OUTPUT [--memory-mb N] [--spill-dir DIR] FILE..." << std::endl;
+        return 1;
+    }
+    
+    // The live history may only be replaced by a merge that includes it
+    if (sameFile(output, kDefaultHistoryFile) &&
+        std::none_of(inputs.begin(), inputs.end(),
+                     [](const std::string& input) { return sameFile(input, kDefaultHistoryFile); })) {
+        std::cerr << output << " is your mood history. List it as an input to merge into it." << std::endl;
+        return 1;
+    }
+    
+    // Rolled-up entries only survive as daily or weekly totals, which can't be
+    // merged entry by entry or checked for duplicates; an output with rollups
+    // would keep them paired with the merged entries
+    std::vector<std::string> files = inputs;
+    files.push_back(output);
+    for (const auto& file : files) {
+        std::string rollupFile = MoodTracker::rollupFileFor(file);
+        if (fs::exists(rollupFile)) {
+            std::cerr << file << " has older entries summarized in " << rollupFile
+                      << ", which can't be merged. Merge histories before they are compacted." << std::endl;
+            return 1;
+        }
+    }
+    
+    // An open session only expects the file to grow, so never replace it
+    // underneath one; the claim also keeps new sessions waiting until done
+    HistoryFileLock sessions = HistoryFileLock::excludingSessions(output);
+    if (!sessions.locked()) {
+        std::cerr << output << " is open in an EmpathyCLI session. Exit the session, then merge again." << std::endl;
+        return 1;
+    }
+    
+    // Hold off appends to the output until it has been replaced
+    HistoryFileLock lock(output);
+    HistoryMerger merger(memoryMb * 1024 * 1024, spillDirectory);
+    if (!merger.merge(inputs, output)) {
+        std::cerr << "Could not merge mood histories. Check that every file exists and is valid." << std::endl;
+        return 1;
+    }
+    
+    std::cout << "Merged " << merger.getEntriesRead() << " entries from " << inputs.size()
+              << " files into " << output << " (" << merger.getEntriesWritten() << " kept, "
+              << merger.getDuplicatesRemoved() << " duplicates removed)." << std::endl;
+    return 0;
+}
@@ -0,0 +1,30 @@
+#ifndef COMMANDS_H
+#define COMMANDS_H
+
+#include <string>
+#include <vector>
+
+// Headless subcommands for scripts, cron jobs and shell hooks.
+//
+// Each command skips the interactive menu and sets up only what it needs:
+// "log" appends to the history file without reading it, "stats" streams the
+// history instead of building a MoodTracker, and "resources" never touches
+// the history at all.
+
+// Run the subcommand named by args[0] (printing usage if it names none);
+// returns the process exit code
+int runCommand(const std::vector<std::string>& args);
+
+// EmpathyCLI log SCORE DESCRIPTION... [--history FILE]
+int runLogCommand(const std::vector<std::string>& args);
+
+// EmpathyCLI stats [--json] [--history FILE]
+int runStatsCommand(const std::vector<std::string>& args);
+
+// EmpathyCLI resources [--mood WORD] [--score N] [--json]
+int runResourcesCommand(const std::vector<std::string>& args);
+
+// EmpathyCLI merge -o OUTPUT [--memory-mb N] [--spill-dir DIR] FILE...
+int runMergeCommand(const std::vector<std::string>& args);
+
+#endif // COMMANDS_H
@@ -0,0 +1,170 @@
+#include "ConcurrentMoodTracker.h"
+#include <algorithm>
+#include <new>
+#include <utility>
+
+namespace {
+
+// Index of the highest set bit (value must be non-zero)
+size_t highestBit(size_t value) {
+    size_t bit = 0;
+    while (value >>= 1) {
+        ++bit;
+    }
+    return bit;
+}
+
+} // namespace
+
+// ConcurrentMoodTracker constructor
+ConcurrentMoodTracker::ConcurrentMoodTracker() {
+    for (auto& segment : segments) {
+        segment.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+// Destroy every constructed entry and release the segments
+ConcurrentMoodTracker::~ConcurrentMoodTracker() {
+    size_t count = reserved.load();
+    for (size_t i = 0; i < count; ++i) {
+        Slot* slot = slotAt(i, false);
+        if (slot && slot->ready.load()) {
+            reinterpret_cast<MoodEntry*>(slot->storage)->~MoodEntry();
+        }
+    }
+    for (auto& segment : segments) {
+        delete[] segment.load();
+    }
+}
+
+// Locate a slot, optionally allocating its segment; nullptr if absent
+ConcurrentMoodTracker::Slot* ConcurrentMoodTracker::slotAt(size_t index, bool allocate) {
+    // Segment i covers indices [64 * (2^i - 1), 64 * (2^(i+1) - 1))
+    size_t segmentIndex = highestBit(index / kFirstSegmentSize + 1);
+    if (segmentIndex >= kMaxSegments) {
+        return nullptr;
+    }
+    size_t offset = index - kFirstSegmentSize * ((size_t(1) << segmentIndex) - 1);
+
+    Slot* segment = segments[segmentIndex].load(std::memory_order_acquire);
+    if (!segment && allocate) {
+        // Race to install a fresh segment; losers discard theirs
+        Slot* fresh = new Slot[kFirstSegmentSize << segmentIndex];
+        if (segments[segmentIndex].compare_exchange_strong(segment, fresh,
+                                                           std::memory_order_acq_rel)) {
+            segment = fresh;
+        } else {
+            delete[] fresh;
+        }
+    }
+    return segment ? &segment[offset] : nullptr;
+}
+
+const ConcurrentMoodTracker::Slot* ConcurrentMoodTracker::slotAt(size_t index) const {
+    return const_cast<ConcurrentMoodTracker*>(this)->slotAt(index, false);
+}
+
+// Advance the published counter over every ready slot.
+// Any producer may publish any other producer's slot, so a slow producer only
+// delays visibility of later entries, never their insertion.
+void ConcurrentMoodTracker::publishReady() {
+    size_t index = published.load();
+    while (index < reserved.load()) {
+        Slot* slot = slotAt(index, false);
+        if (!slot || !slot->ready.load()) {
+            // Its producer will publish it (and everything after) when done
+            return;
+        }
+
+        // Extend the running aggregates; every helper computes the same values
+        int score = slot->entry().score;
+        long long sum = score;
+        int lowest = score;
+        int highest = score;
+        if (index > 0) {
+            const Slot* previous = slotAt(index - 1);
+            sum += previous->prefixSum.load(std::memory_order_relaxed);
+            lowest = std::min(lowest, previous->prefixLowest.load(std::memory_order_relaxed));
+            highest = std::max(highest, previous->prefixHighest.load(std::memory_order_relaxed));
+        }
+        slot->prefixSum.store(sum, std::memory_order_relaxed);
+        slot->prefixLowest.store(lowest, std::memory_order_relaxed);
+        slot->prefixHighest.store(highest, std::memory_order_relaxed);
+
+        // On failure index is reloaded with the current published count
+        if (published.compare_exchange_weak(index, index + 1)) {
+            ++index;
+        }
+    }
+}
+
+// Add an entry, keeping its timestamp (safe to call from any thread, lock-free)
+void ConcurrentMoodTracker::addMoodEntry(const MoodEntry& entry) {
+    // Copy before reserving so a failed allocation can't leave a hole
+    MoodEntry copy = entry;
+
+    size_t index = reserved.fetch_add(1);
+    Slot* slot = slotAt(index, true);
+    if (!slot) {
+        throw std::bad_alloc();
+    }
+    new (slot->storage) MoodEntry(std::move(copy));
+    slot->ready.store(true);
+
+    publishReady();
+}
+
+// Number of entries currently visible to readers
+size_t ConcurrentMoodTracker::size() const {
+    return published.load();
+}
+
+// Average over the visible entries in O(1)
+double ConcurrentMoodTracker::getAverageMoodScore() const {
+    size_t count = published.load();
+    if (count == 0) {
+        return 5.0; // Default neutral score if no entries
+    }
+    return static_cast<double>(slotAt(count - 1)->prefixSum.load(std::memory_order_relaxed)) / count;
+}
+
+// Copy the visible entries and their aggregates
+MoodSnapshot ConcurrentMoodTracker::snapshot() const {
+    MoodSnapshot result;
+    size_t count = published.load();
+    if (count == 0) {
+        return result;
+    }
+
+    result.entries.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        result.entries.push_back(slotAt(i)->entry());
+    }
+
+    const Slot* last = slotAt(count - 1);
+    result.count = count;
+    result.averageScore = static_cast<double>(last->prefixSum.load(std::memory_order_relaxed)) / count;
+    result.lowestScore = last->prefixLowest.load(std::memory_order_relaxed);
+    result.highestScore = last->prefixHighest.load(std::memory_order_relaxed);
+    return result;
+}
+
+// Copy the visible entries from index first onwards
+std::vector<MoodEntry> ConcurrentMoodTracker::entriesSince(size_t first) const {
+    std::vector<MoodEntry> entries;
+    size_t count = published.load();
+    for (size_t i = first; i < count; ++i) {
+        entries.push_back(slotAt(i)->entry());
+    }
+    return entries;
+}
+
+// Add the visible entries from index first onwards to a single-threaded
+// tracker; returns the index to continue from next time
+size_t ConcurrentMoodTracker::exportTo(MoodTracker& tracker, size_t first) const {
+    size_t count = published.load();
+    for (size_t i = first; i < count; ++i) {
+        tracker.addMoodEntry(slotAt(i)->entry());
+    }
+    return std::max(first, count);
+}
@@ -0,0 +1,89 @@
+#ifndef CONCURRENT_MOOD_TRACKER_H
+#define CONCURRENT_MOOD_TRACKER_H
+
+#include "MoodTracker.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Consistent point-in-time view of a concurrent mood history
+struct MoodSnapshot {
+    std::vector<MoodEntry> entries;     // Published entries, in publish order
+    size_t count = 0;                   // Number of entries in the snapshot
+    double averageScore = 5.0;          // Average score (neutral if empty)
+    int lowestScore = 0;                // Lowest score (0 if empty)
+    int highestScore = 0;               // Highest score (0 if empty)
+};
+
+// Mood history that many threads can append to and read from at once.
+//
+// Entries live in append-only segments that double in size and are never
+// moved or freed until destruction. Producers reserve a slot with a single
+// atomic increment, fill it in, and then help advance a "published" counter
+// over every contiguous ready slot. Readers only look at the published
+// prefix, so they never block writers and always see complete entries along
+// with aggregates that match exactly those entries.
+//
+// Entries are stored as given. Sentiment, word counts and alerts are the
+// job of the MoodTracker they are exported to, which keeps the sequential
+// state the app reads from.
+class ConcurrentMoodTracker {
+private:
+    // One entry's storage plus the running aggregates up to and including it
+    struct Slot {
+        alignas(MoodEntry) unsigned char storage[sizeof(MoodEntry)];
+        std::atomic<bool> ready{false};             // Entry constructed
+        std::atomic<long long> prefixSum{0};        // Sum of scores [0, index]
+        std::atomic<int> prefixLowest{0};           // Lowest score [0, index]
+        std::atomic<int> prefixHighest{0};          // Highest score [0, index]
+
+        const MoodEntry& entry() const {
+            return *reinterpret_cast<const MoodEntry*>(storage);
+        }
+    };
+
+    static constexpr size_t kFirstSegmentSize = 64;     // Segment i holds 64 << i slots
+    static constexpr size_t kMaxSegments = 48;
+
+    std::array<std::atomic<Slot*>, kMaxSegments> segments;
+    std::atomic<size_t> reserved{0};                // Slots handed out to producers
+    std::atomic<size_t> published{0};               // Contiguous ready prefix
+
+    // Locate a slot, optionally allocating its segment; nullptr if absent
+    Slot* slotAt(size_t index, bool allocate);
+    const Slot* slotAt(size_t index) const;
+
+    // Advance the published counter over every ready slot
+    void publishReady();
+
+public:
+    ConcurrentMoodTracker();
+    ~ConcurrentMoodTracker();
+
+    ConcurrentMoodTracker(const ConcurrentMoodTracker&) = delete;
+    ConcurrentMoodTracker& operator=(const ConcurrentMoodTracker&) = delete;
+
+    // Add an entry, keeping its timestamp (safe to call from any thread, lock-free)
+    void addMoodEntry(const MoodEntry& entry);
+
+    // Number of entries currently visible to readers
+    size_t size() const;
+
+    // Average over the visible entries in O(1)
+    double getAverageMoodScore() const;
+
+    // Copy the visible entries and their aggregates
+    MoodSnapshot snapshot() const;
+
+    // Copy the visible entries from index first onwards
+    std::vector<MoodEntry> entriesSince(size_t first) const;
+
+    // Add the visible entries from index first onwards to a single-threaded
+    // tracker (which scores them and counts their words and alerts);
+    // returns the index to continue from next time
+    size_t exportTo(MoodTracker& tracker, size_t first = 0) const;
+};
+
+#endif // CONCURRENT_MOOD_TRACKER_H
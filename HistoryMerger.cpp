@@ -0,0 +1,261 @@
+#include "HistoryMerger.h"
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <queue>
+#include <random>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Head of one sorted run inside the merge heap
+struct RunHead {
+    MoodRecord record;
+    size_t run;
+};
+
+// Orders the heap so the earliest record sits on top
+struct LaterRecord {
+    bool operator()(const RunHead& a, const RunHead& b) const {
+        if (b.record < a.record) return true;
+        if (a.record < b.record) return false;
+        return a.run > b.run;
+    }
+};
+
+} // namespace
+
+// HistoryMerger constructor
+HistoryMerger::HistoryMerger(size_t memoryBudget, const std::string& spillRoot)
+    : memoryBudget(memoryBudget), spillRoot(spillRoot) {}
+
+// Make sure no spill files outlive the merger
+HistoryMerger::~HistoryMerger() {
+    cleanup();
+}
+
+// Merge every input into output; false if any input is unreadable
+bool HistoryMerger::merge(const std::vector<std::string>& inputs, const std::string& output) {
+    entriesRead = 0;
+    entriesWritten = 0;
+    duplicatesRemoved = 0;
+
+    if (!createSpillDirectory()) {
+        return false;
+    }
+
+    // Sorted inputs merge directly; unsorted ones become sorted runs first
+    std::vector<std::string> runs;
+    for (const auto& input : inputs) {
+        bool sorted = false;
+        if (!isSorted(input, sorted)) {
+            cleanup();
+            return false;
+        }
+        if (sorted) {
+            runs.push_back(input);
+        } else if (!spillSortedRuns(input, runs)) {
+            cleanup();
+            return false;
+        }
+    }
+
+    // Too many runs to open at once: merge them in groups first
+    while (runs.size() > kMaxFanIn) {
+        std::vector<std::string> merged;
+        for (size_t start = 0; start < runs.size(); start += kMaxFanIn) {
+            size_t end = std::min(runs.size(), start + kMaxFanIn);
+            std::vector<std::string> group(runs.begin() + start, runs.begin() + end);
+            std::string spill = nextSpillFile();
+            size_t written = 0;
+            if (!mergeRuns(group, spill, written)) {
+                cleanup();
+                return false;
+            }
+            merged.push_back(spill);
+        }
+        runs.swap(merged);
+    }
+
+    // Write next to the output and rename, so an input may also be the output
+    std::error_code ec;
+    std::string staging = output + ".merging";
+    if (!mergeRuns(runs, staging, entriesWritten)) {
+        fs::remove(staging, ec);
+        cleanup();
+        return false;
+    }
+    fs::rename(staging, output, ec);
+    cleanup();
+    if (ec) {
+        return false;
+    }
+
+    duplicatesRemoved = entriesRead - entriesWritten;
+    return true;
+}
+
+// Check whether a file is already in timestamp order (streams it once)
+bool HistoryMerger::isSorted(const std::string& filename, bool& sorted) {
+    MoodHistoryReader reader(filename);
+    MoodRecord previous;
+    MoodRecord record;
+    bool first = true;
+    sorted = true;
+
+    while (reader.next(record)) {
+        ++entriesRead;
+        if (!first && record < previous) {
+            sorted = false;
+        }
+        previous = std::move(record);
+        first = false;
+    }
+    return reader.good();
+}
+
+// Split an unsorted file into sorted runs on disk
+bool HistoryMerger::spillSortedRuns(const std::string& filename, std::vector<std::string>& runs) {
+    MoodHistoryReader reader(filename);
+    std::vector<MoodRecord> chunk;
+    size_t chunkBytes = 0;
+    MoodRecord record;
+
+    while (reader.next(record)) {
+        chunkBytes += record.memoryUsage();
+        chunk.push_back(std::move(record));
+        if (chunkBytes >= memoryBudget) {
+            if (!writeRun(chunk, runs)) {
+                return false;
+            }
+            chunkBytes = 0;
+        }
+    }
+    if (!reader.good()) {
+        return false;
+    }
+    return chunk.empty() || writeRun(chunk, runs);
+}
+
+// Write one in-memory chunk as a sorted run
+bool HistoryMerger::writeRun(std::vector<MoodRecord>& chunk, std::vector<std::string>& runs) {
+    std::sort(chunk.begin(), chunk.end());
+    chunk.erase(std::unique(chunk.begin(), chunk.end()), chunk.end());
+
+    std::string spill = nextSpillFile();
+    MoodHistoryWriter writer(spill);
+    for (const auto& record : chunk) {
+        writer.write(record);
+    }
+    chunk.clear();
+
+    if (!writer.finish()) {
+        return false;
+    }
+    runs.push_back(spill);
+    return true;
+}
+
+// Heap-merge sorted runs into a file, dropping duplicates
+bool HistoryMerger::mergeRuns(const std::vector<std::string>& runs, const std::string& output,
+                              size_t& written) {
+    std::vector<std::unique_ptr<MoodHistoryReader>> readers;
+    std::priority_queue<RunHead, std::vector<RunHead>, LaterRecord> heap;
+
+    for (size_t i = 0; i < runs.size(); ++i) {
+        readers.push_back(std::make_unique<MoodHistoryReader>(runs[i]));
+        MoodRecord record;
+        if (readers[i]->next(record)) {
+            heap.push({std::move(record), i});
+        }
+    }
+
+    MoodHistoryWriter writer(output);
+    if (!writer.good()) {
+        return false;
+    }
+
+    // Duplicates compare equal, so they always surface back to back
+    MoodRecord last;
+    bool haveLast = false;
+    written = 0;
+
+    while (!heap.empty()) {
+        RunHead head = heap.top();
+        heap.pop();
+
+        if (!haveLast || !(head.record == last)) {
+            writer.write(head.record);
+            ++written;
+            last = head.record;
+            haveLast = true;
+        }
+
+        if (readers[head.run]->next(head.record)) {
+            heap.push(std::move(head));
+        }
+    }
+
+    for (const auto& reader : readers) {
+        if (!reader->good()) {
+            return false;
+        }
+    }
+    return writer.finish();
+}
+
+// Name for the next spill file
+std::string HistoryMerger::nextSpillFile() {
+    std::string name = (fs::path(spillDirectory) /
+                        ("run-" + std::to_string(spillFiles.size()) + ".json")).string();
+    spillFiles.push_back(name);
+    return name;
+}
+
+// Create a new, uniquely named spill directory under spillRoot
+bool HistoryMerger::createSpillDirectory() {
+    std::error_code ec;
+    fs::path root = spillRoot.empty() ? fs::temp_directory_path(ec) : fs::path(spillRoot);
+    if (ec) {
+        return false;
+    }
+    fs::create_directories(root, ec);
+
+    // create_directory fails on an existing name, so the directory is ours alone
+    std::random_device rd;
+    for (int attempt = 0; attempt < 16; ++attempt) {
+        fs::path candidate = root / ("empathycli-merge-" + std::to_string(rd()));
+        if (fs::create_directory(candidate, ec)) {
+            spillDirectory = candidate.string();
+            return true;
+        }
+    }
+    return false;
+}
+
+// Remove every spill file and the private spill directory
+void HistoryMerger::cleanup() {
+    std::error_code ec;
+    for (const auto& spill : spillFiles) {
+        fs::remove(spill, ec);
+    }
+    spillFiles.clear();
+    if (!spillDirectory.empty()) {
+        fs::remove(spillDirectory, ec);
+        spillDirectory.clear();
+    }
+}
+
+// Statistics from the last merge
+size_t HistoryMerger::getEntriesRead() const {
+    return entriesRead;
+}
+
+size_t HistoryMerger::getEntriesWritten() const {
+    return entriesWritten;
+}
+
+size_t HistoryMerger::getDuplicatesRemoved() const {
+    return duplicatesRemoved;
+}
@@ -0,0 +1,66 @@
+#ifndef HISTORY_MERGER_H
+#define HISTORY_MERGER_H
+
+#include "MoodHistoryFile.h"
+#include <string>
+#include <vector>
+
+// Merges several mood history files into one chronological, duplicate-free file.
+//
+// Inputs that are already in timestamp order are streamed straight into a
+// k-way heap merge. Unsorted inputs are first broken into sorted runs that fit
+// the memory budget and spilled to disk, so no input is ever held in memory
+// as a whole.
+class HistoryMerger {
+private:
+    size_t memoryBudget;                    // Bytes of records held while sorting runs
+    std::string spillRoot;                  // Where spill directories are created
+    std::string spillDirectory;             // This merge's private directory under spillRoot
+    std::vector<std::string> spillFiles;    // Runs created so far (removed on cleanup)
+
+    size_t entriesRead = 0;
+    size_t entriesWritten = 0;
+    size_t duplicatesRemoved = 0;
+
+    // Check whether a file is already in timestamp order (streams it once)
+    bool isSorted(const std::string& filename, bool& sorted);
+
+    // Split an unsorted file into sorted runs on disk
+    bool spillSortedRuns(const std::string& filename, std::vector<std::string>& runs);
+
+    // Write one in-memory chunk as a sorted run
+    bool writeRun(std::vector<MoodRecord>& chunk, std::vector<std::string>& runs);
+
+    // Heap-merge sorted runs into a file, dropping duplicates
+    bool mergeRuns(const std::vector<std::string>& runs, const std::string& output, size_t& written);
+
+    // Name for the next spill file
+    std::string nextSpillFile();
+
+    // Create a new, uniquely named spill directory under spillRoot
+    bool createSpillDirectory();
+
+    // Remove every spill file and the private spill directory
+    void cleanup();
+
+public:
+    // Maximum number of runs merged at once (bounded by open file handles)
+    static constexpr size_t kMaxFanIn = 64;
+
+    // memoryBudget is in bytes; spill files go into a private directory
+    // created under spillRoot (the system temp directory when empty), so
+    // nothing already there is touched
+    explicit HistoryMerger(size_t memoryBudget = 64 * 1024 * 1024,
+                           const std::string& spillRoot = "");
+    ~HistoryMerger();
+
+    // Merge every input into output; false if any input is unreadable
+    bool merge(const std::vector<std::string>& inputs, const std::string& output);
+
+    // Statistics from the last merge
+    size_t getEntriesRead() const;
+    size_t getEntriesWritten() const;
+    size_t getDuplicatesRemoved() const;
+};
+
+#endif // HISTORY_MERGER_H
@@ -0,0 +1,175 @@
+#include "HistorySync.h"
+#include "MoodHistoryFile.h"
+#include <chrono>
+#include <filesystem>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// How often the background thread looks for entries logged elsewhere
+constexpr std::chrono::seconds kPollInterval(1);
+
+} // namespace
+
+HistorySync::HistorySync(const std::string& historyFile)
+    : historyFile(historyFile), sessionLock(HistoryFileLock::forSession(historyFile)) {}
+
+// Stops the background thread after a last sync
+HistorySync::~HistorySync() {
+    stop();
+}
+
+// Push records past syncedRecords into incoming; mutex and file lock held
+void HistorySync::importLocked() {
+    std::error_code ec;
+    std::uintmax_t size = fs::file_size(historyFile, ec);
+    if (ec || size == syncedSize) {
+        return;
+    }
+
+    // While the session lock is held other writers only append, so
+    // everything past the records we already hold is new
+    MoodHistoryReader reader(historyFile);
+    MoodRecord record;
+    size_t index = 0;
+    while (reader.next(record)) {
+        if (index++ >= syncedRecords) {
+            incoming.addMoodEntry(record.toEntry());
+            syncedRecords = index;
+        }
+    }
+    if (reader.good()) {
+        syncedSize = size;
+    }
+}
+
+// Remember the current file size; mutex and file lock held
+void HistorySync::markSynced() {
+    std::error_code ec;
+    syncedSize = fs::file_size(historyFile, ec);
+    if (ec) {
+        syncedSize = 0;
+    }
+}
+
+// Import appended records and append unsaved outgoing entries; mutex held
+bool HistorySync::syncLocked() {
+    std::error_code ec;
+    std::uintmax_t size = fs::file_size(historyFile, ec);
+    bool pending = outgoingSaved < outgoing.size();
+    if (!pending && (ec || size == syncedSize)) {
+        return true;
+    }
+
+    HistoryFileLock lock(historyFile, pending);
+    if (!lock.locked()) {
+        return false;
+    }
+    importLocked();
+
+    for (const auto& entry : outgoing.entriesSince(outgoingSaved)) {
+        if (!appendMoodRecord(historyFile, MoodRecord::fromEntry(entry))) {
+            return false;
+        }
+        ++syncedRecords;
+        ++outgoingSaved;
+        markSynced();
+    }
+    return true;
+}
+
+// Background loop: sync whenever woken or every kPollInterval
+void HistorySync::run() {
+    std::unique_lock<std::mutex> guard(mutex);
+    while (!stopping) {
+        syncLocked();
+        wake.wait_for(guard, kPollInterval);
+    }
+}
+
+// Load the tracker from the history file (and its rollups). If that
+// fails, nothing is written to the file for the rest of the session.
+bool HistorySync::load(MoodTracker& tracker) {
+    HistoryFileLock lock(historyFile, false);
+    if (!tracker.loadMoodHistory(historyFile)) {
+        writable = false;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> guard(mutex);
+    syncedRecords = tracker.getMoodHistory().size();
+    markSynced();
+    return true;
+}
+
+// False once a load has failed
+bool HistorySync::isWritable() const {
+    return writable;
+}
+
+// Start importing and saving in the background
+void HistorySync::start() {
+    if (writable && !worker.joinable()) {
+        worker = std::thread(&HistorySync::run, this);
+    }
+}
+
+// Add entries other processes appended to the tracker; returns how many
+size_t HistorySync::importAppended(MoodTracker& tracker) {
+    size_t before = incomingExported;
+    incomingExported = incoming.exportTo(tracker, incomingExported);
+    return incomingExported - before;
+}
+
+// Queue an entry the tracker just added for saving; false if the file
+// is not writable
+bool HistorySync::append(const MoodEntry& entry) {
+    if (!writable) {
+        return false;
+    }
+    outgoing.addMoodEntry(entry);
+    wake.notify_one();
+    return true;
+}
+
+// Rewrite the whole file from the tracker, importing other appends first
+bool HistorySync::rewrite(MoodTracker& tracker) {
+    if (!writable) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> guard(mutex);
+    HistoryFileLock lock(historyFile);
+    if (!lock.locked()) {
+        return false;
+    }
+    importLocked();
+    importAppended(tracker);
+
+    // Everything logged in this session is already in the tracker
+    if (!tracker.saveMoodHistory(historyFile)) {
+        return false;
+    }
+    outgoingSaved = outgoing.size();
+    syncedRecords = tracker.getMoodHistory().size();
+    markSynced();
+    return true;
+}
+
+// Stop the background thread after a last sync; false if some logged
+// entries could not be saved
+bool HistorySync::stop() {
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    if (worker.joinable()) {
+        worker.join();
+    }
+
+    std::lock_guard<std::mutex> guard(mutex);
+    return !writable || (syncLocked() && outgoingSaved == outgoing.size());
+}
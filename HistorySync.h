@@ -0,0 +1,94 @@
+#ifndef HISTORY_SYNC_H
+#define HISTORY_SYNC_H
+
+#include "MoodTracker.h"
+#include "ConcurrentMoodTracker.h"
+#include "MoodHistoryFile.h"
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Keeps an interactive session's MoodTracker in step with its history file.
+//
+// Other processes (`EmpathyCLI log` run from cron or a shell hook) may append
+// to the file while a session is open. Instead of saving its whole history
+// over the file, the session appends its own entries and picks up everyone
+// else's; the file is only rewritten after compaction, once the appended
+// entries have been imported. Every file access holds a HistoryFileLock, and
+// the session lock is held throughout so that no other process replaces the
+// file wholesale while the session relies on it only growing.
+//
+// The file work runs on a background thread so the menu never waits on it.
+// Entries cross between the threads through two ConcurrentMoodTrackers:
+// "outgoing" holds what the UI logged, in order, for the saver to append;
+// "incoming" holds what the importer found in the file, for the UI to add
+// to its tracker at its own pace.
+class HistorySync {
+private:
+    std::string historyFile;
+    HistoryFileLock sessionLock;        // Keeps merge from replacing the file under us
+    bool writable = true;               // False after a failed load, so the file is never clobbered
+
+    ConcurrentMoodTracker outgoing;     // Entries logged in this session
+    ConcurrentMoodTracker incoming;     // Entries other processes appended
+    size_t incomingExported = 0;        // Incoming entries already in the UI's tracker (UI thread only)
+
+    // Guarded by mutex
+    std::mutex mutex;
+    std::condition_variable wake;
+    size_t syncedRecords = 0;           // Leading records of the file already held by the session
+    std::uintmax_t syncedSize = 0;      // File size when last synced, to skip unchanged files
+    size_t outgoingSaved = 0;           // Outgoing entries already in the file
+    bool stopping = false;
+
+    std::thread worker;
+
+    // Import appended records and append unsaved outgoing entries; mutex held
+    bool syncLocked();
+
+    // Push records past syncedRecords into incoming; mutex and file lock held
+    void importLocked();
+
+    // Remember the current file size; mutex and file lock held
+    void markSynced();
+
+    // Background loop: sync whenever woken or every kPollInterval
+    void run();
+
+public:
+    explicit HistorySync(const std::string& historyFile);
+
+    // Stops the background thread after a last sync
+    ~HistorySync();
+
+    HistorySync(const HistorySync&) = delete;
+    HistorySync& operator=(const HistorySync&) = delete;
+
+    // Load the tracker from the history file (and its rollups). If that
+    // fails, nothing is written to the file for the rest of the session.
+    bool load(MoodTracker& tracker);
+
+    // False once a load has failed
+    bool isWritable() const;
+
+    // Start importing and saving in the background
+    void start();
+
+    // Add entries other processes appended to the tracker; returns how many
+    size_t importAppended(MoodTracker& tracker);
+
+    // Queue an entry the tracker just added for saving; false if the file
+    // is not writable
+    bool append(const MoodEntry& entry);
+
+    // Rewrite the whole file from the tracker, importing other appends first
+    bool rewrite(MoodTracker& tracker);
+
+    // Stop the background thread after a last sync; false if some logged
+    // entries could not be saved
+    bool stop();
+};
+
+#endif // HISTORY_SYNC_H
@@ -0,0 +1,100 @@
+#include "LocalDate.h"
+#include <cstdio>
+#include <ctime>
+
+namespace {
+
+// Days since 1970-01-01 for a civil date (proleptic Gregorian calendar)
+long long daysFromCivil(long long year, unsigned month, unsigned day) {
+    year -= month <= 2;
+    long long era = (year >= 0 ? year : year - 399) / 400;
+    unsigned yearOfEra = static_cast<unsigned>(year - era * 400);
+    unsigned dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + static_cast<long long>(dayOfEra) - 719468;
+}
+
+// Civil date for a day number (inverse of daysFromCivil)
+void civilFromDays(long long days, long long& year, unsigned& month, unsigned& day) {
+    days += 719468;
+    long long era = (days >= 0 ? days : days - 146096) / 146097;
+    unsigned dayOfEra = static_cast<unsigned>(days - era * 146097);
+    unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    unsigned monthPrime = (5 * dayOfYear + 2) / 153;
+    day = dayOfYear - (153 * monthPrime + 2) / 5 + 1;
+    month = monthPrime < 10 ? monthPrime + 3 : monthPrime - 9;
+    year = static_cast<long long>(yearOfEra) + era * 400 + (month <= 2);
+}
+
+} // namespace
+
+// Broken-down local time; unlike std::localtime, safe to call from any thread
+std::tm toLocalTime(std::time_t time) {
+    std::tm local = {};
+#ifdef _WIN32
+    localtime_s(&local, &time);
+#else
+    localtime_r(&time, &local);
+#endif
+    return local;
+}
+
+// Local calendar day of a timestamp
+long long localDayNumber(const std::chrono::system_clock::time_point& time) {
+    std::tm local = toLocalTime(std::chrono::system_clock::to_time_t(time));
+    return daysFromCivil(local.tm_year + 1900, local.tm_mon + 1, local.tm_mday);
+}
+
+// Local midnight at the start of a day
+std::chrono::system_clock::time_point startOfLocalDay(long long day) {
+    long long year;
+    unsigned month, dayOfMonth;
+    civilFromDays(day, year, month, dayOfMonth);
+
+    std::tm tm = {};
+    tm.tm_year = static_cast<int>(year - 1900);
+    tm.tm_mon = static_cast<int>(month) - 1;
+    tm.tm_mday = static_cast<int>(dayOfMonth);
+    tm.tm_isdst = -1;
+    return std::chrono::system_clock::from_time_t(std::mktime(&tm));
+}
+
+// Monday on or before a day, so weeks run Monday to Sunday
+long long startOfWeek(long long day) {
+    // Day 0 (1970-01-01) was a Thursday, three days after a Monday
+    long long sinceMonday = ((day + 3) % 7 + 7) % 7;
+    return day - sinceMonday;
+}
+
+// First day of the month containing a day
+long long startOfMonth(long long day) {
+    long long year;
+    unsigned month, dayOfMonth;
+    civilFromDays(day, year, month, dayOfMonth);
+    return day - (dayOfMonth - 1);
+}
+
+// Format a day as "YYYY-MM-DD"
+std::string formatDayNumber(long long day) {
+    long long year;
+    unsigned month, dayOfMonth;
+    civilFromDays(day, year, month, dayOfMonth);
+
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%04lld-%02u-%02u", year, month, dayOfMonth);
+    return buffer;
+}
+
+// Parse "YYYY-MM-DD"; false if the text isn't a valid date
+bool parseDayNumber(const std::string& text, long long& day) {
+    long long year;
+    unsigned month, dayOfMonth;
+    char trailing;
+    if (std::sscanf(text.c_str(), "%lld-%u-%u%c", &year, &month, &dayOfMonth, &trailing) != 3 ||
+        month < 1 || month > 12 || dayOfMonth < 1 || dayOfMonth > 31) {
+        return false;
+    }
+    day = daysFromCivil(year, month, dayOfMonth);
+    return formatDayNumber(day) == text;
+}
@@ -0,0 +1,32 @@
+#ifndef LOCAL_DATE_H
+#define LOCAL_DATE_H
+
+#include <chrono>
+#include <ctime>
+#include <string>
+
+// Helpers for working with calendar days in the user's local time zone.
+// Days are numbered from 1970-01-01 (day 0), so consecutive days differ by one.
+
+// Broken-down local time; unlike std::localtime, safe to call from any thread
+std::tm toLocalTime(std::time_t time);
+
+// Local calendar day of a timestamp
+long long localDayNumber(const std::chrono::system_clock::time_point& time);
+
+// Local midnight at the start of a day
+std::chrono::system_clock::time_point startOfLocalDay(long long day);
+
+// Monday on or before a day, so weeks run Monday to Sunday
+long long startOfWeek(long long day);
+
+// First day of the month containing a day
+long long startOfMonth(long long day);
+
+// Format a day as "YYYY-MM-DD"
+std::string formatDayNumber(long long day);
+
+// Parse "YYYY-MM-DD"; false if the text isn't a valid date
+bool parseDayNumber(const std::string& text, long long& day);
+
+#endif // LOCAL_DATE_H
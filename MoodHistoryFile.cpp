@@ -0,0 +1,305 @@
+#include "MoodHistoryFile.h"
+#include "LocalDate.h"
+#include <nlohmann/json.hpp>
+#include <sstream>
+#include <iomanip>
+#include <tuple>
+#include <cctype>
+#include <algorithm>
+#include <cerrno>
+#include <filesystem>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+
+using json = nlohmann::json;
+
+// Build a record from an in-memory entry
+MoodRecord MoodRecord::fromEntry(const MoodEntry& entry) {
+    auto timeT = std::chrono::system_clock::to_time_t(entry.timestamp);
+    std::tm local = toLocalTime(timeT);
+    std::stringstream ss;
+    ss << std::put_time(&local, "%Y-%m-%d %H:%M:%S");
+
+    MoodRecord record;
+    record.timestamp = ss.str();
+    record.score = entry.score;
+    record.description = entry.description;
+    return record;
+}
+
+// Convert a record back into an in-memory entry
+MoodEntry MoodRecord::toEntry() const {
+    MoodEntry entry(score, description);
+
+    std::tm tm = {};
+    std::istringstream ss(timestamp);
+    ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
+    entry.timestamp = std::chrono::system_clock::from_time_t(std::mktime(&tm));
+    return entry;
+}
+
+// Approximate heap footprint, used for memory budgeting
+size_t MoodRecord::memoryUsage() const {
+    return sizeof(MoodRecord) + timestamp.capacity() + description.capacity();
+}
+
+// Records order by timestamp, then score, then description
+bool operator<(const MoodRecord& a, const MoodRecord& b) {
+    return std::tie(a.timestamp, a.score, a.description) <
+           std::tie(b.timestamp, b.score, b.description);
+}
+
+bool operator==(const MoodRecord& a, const MoodRecord& b) {
+    return a.score == b.score && a.timestamp == b.timestamp && a.description == b.description;
+}
+
+// Open a history file; check good() afterwards
+MoodHistoryReader::MoodHistoryReader(const std::string& filename) : inFile(filename) {
+    if (!inFile.is_open() || nextToken() != '[') {
+        failed = true;
+    }
+}
+
+// Skip whitespace and return the next character (EOF at end of stream)
+int MoodHistoryReader::nextToken() {
+    int c = inFile.get();
+    while (c != EOF && std::isspace(c)) {
+        c = inFile.get();
+    }
+    return c;
+}
+
+// Read one JSON object whose opening brace was already consumed
+bool MoodHistoryReader::readObject(std::string& object) {
+    object.assign(1, '{');
+    int depth = 1;
+    bool inString = false;
+    bool escaped = false;
+
+    int c;
+    while (depth > 0 && (c = inFile.get()) != EOF) {
+        object.push_back(static_cast<char>(c));
+        if (inString) {
+            if (escaped) {
+                escaped = false;
+            } else if (c == '\\') {
+                escaped = true;
+            } else if (c == '"') {
+                inString = false;
+            }
+        } else if (c == '"') {
+            inString = true;
+        } else if (c == '{') {
+            ++depth;
+        } else if (c == '}') {
+            --depth;
+        }
+    }
+    return depth == 0;
+}
+
+// Read the next record; false at the end of the file or on error
+bool MoodHistoryReader::next(MoodRecord& record) {
+    if (failed || finished) {
+        return false;
+    }
+
+    int c = nextToken();
+    if (c == ',') {
+        c = nextToken();
+    }
+    if (c == ']') {
+        finished = true;
+        return false;
+    }
+
+    std::string object;
+    if (c != '{' || !readObject(object)) {
+        failed = true;
+        return false;
+    }
+
+    try {
+        json entryJson = json::parse(object);
+        record.score = entryJson["score"];
+        record.description = entryJson["description"];
+        record.timestamp = entryJson["timestamp"];
+        return true;
+    } catch (...) {
+        failed = true;
+        return false;
+    }
+}
+
+// True unless the file could not be opened or was malformed
+bool MoodHistoryReader::good() const {
+    return !failed;
+}
+
+// Create (or truncate) a history file; check good() afterwards
+MoodHistoryWriter::MoodHistoryWriter(const std::string& filename) : outFile(filename) {
+    if (outFile.is_open()) {
+        outFile << "[";
+    }
+}
+
+// Append one record to the array
+void MoodHistoryWriter::write(const MoodRecord& record) {
+    outFile << (empty ? "\n" : ",\n") << formatMoodRecord(record);
+    empty = false;
+}
+
+// Close the array; returns false if any write failed
+bool MoodHistoryWriter::finish() {
+    outFile << (empty ? "]" : "\n]") << std::endl;
+    outFile.close();
+    return !outFile.fail();
+}
+
+// True while every write has succeeded
+bool MoodHistoryWriter::good() const {
+    return outFile.is_open() && outFile.good();
+}
+
+// Block until the lock is held; check locked() afterwards
+HistoryFileLock::HistoryFileLock(const std::string& historyFile, bool exclusive)
+    : HistoryFileLock(LockFile(), historyFile + ".lock", exclusive, true) {}
+
+// Lock an arbitrary lock file, optionally without waiting
+HistoryFileLock::HistoryFileLock(LockFile, const std::string& lockFile, bool exclusive, bool wait) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(lockFile.c_str(), GENERIC_READ | GENERIC_WRITE,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    handle = file;
+    DWORD flags = (exclusive ? LOCKFILE_EXCLUSIVE_LOCK : 0) | (wait ? 0 : LOCKFILE_FAIL_IMMEDIATELY);
+    OVERLAPPED overlapped = {};
+    held = LockFileEx(file, flags, 0, 1, 0, &overlapped);
+#else
+    fd = ::open(lockFile.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return;
+    }
+    int operation = (exclusive ? LOCK_EX : LOCK_SH) | (wait ? 0 : LOCK_NB);
+    int result;
+    do {
+        result = ::flock(fd, operation);
+    } while (result != 0 && errno == EINTR);
+    held = result == 0;
+#endif
+}
+
+// Mark the history as open in an interactive session (waits while it
+// is being replaced)
+HistoryFileLock HistoryFileLock::forSession(const std::string& historyFile) {
+    return HistoryFileLock(LockFile(), historyFile + ".session", false, true);
+}
+
+// Claim the history for replacing it; not locked() if a session has it open
+HistoryFileLock HistoryFileLock::excludingSessions(const std::string& historyFile) {
+    return HistoryFileLock(LockFile(), historyFile + ".session", true, false);
+}
+
+// Closing the file releases the lock
+HistoryFileLock::~HistoryFileLock() {
+#ifdef _WIN32
+    if (handle) {
+        CloseHandle(static_cast<HANDLE>(handle));
+    }
+#else
+    if (fd >= 0) {
+        ::close(fd);
+    }
+#endif
+}
+
+// True if the lock could be taken
+bool HistoryFileLock::locked() const {
+    return held;
+}
+
+// Format a single record the way saveMoodHistory lays out array elements
+std::string formatMoodRecord(const MoodRecord& record) {
+    json entryJson = {
+        {"score", record.score},
+        {"description", record.description},
+        {"timestamp", record.timestamp}
+    };
+
+    // Indent every line one level, as it sits inside the top-level array
+    std::istringstream lines(entryJson.dump(4));
+    std::string line;
+    std::string formatted;
+    while (std::getline(lines, line)) {
+        if (!formatted.empty()) {
+            formatted += '\n';
+        }
+        formatted += "    " + line;
+    }
+    return formatted;
+}
+
+// Append a record to a history file without parsing the existing entries
+bool appendMoodRecord(const std::string& filename, const MoodRecord& record) {
+    std::fstream file(filename, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekg(0, std::ios::end);
+    std::streamoff size = file.is_open() ? static_cast<std::streamoff>(file.tellg()) : 0;
+    if (size <= 0) {
+        // No history yet (or an empty file): start a new one
+        file.close();
+        MoodHistoryWriter writer(filename);
+        writer.write(record);
+        return writer.finish();
+    }
+
+    // Only the tail matters: find the closing bracket and what precedes it
+    std::streamoff tailSize = std::min<std::streamoff>(size, 4096);
+    std::string tail(static_cast<size_t>(tailSize), '\0');
+    file.seekg(size - tailSize);
+    file.read(&tail[0], tailSize);
+    if (!file) {
+        return false;
+    }
+
+    size_t pos = tail.find_last_not_of(" \t\r\n");
+    if (pos == std::string::npos || tail[pos] != ']') {
+        return false;
+    }
+    size_t previous = pos == 0 ? std::string::npos : tail.find_last_not_of(" \t\r\n", pos - 1);
+    if (previous == std::string::npos) {
+        // The whole array might not fit in the tail; only "[]" is handled here
+        return false;
+    }
+
+    // Overwrite everything after the last element (or after '[' if there is none)
+    std::streamoff writeAt = size - tailSize + static_cast<std::streamoff>(previous) + 1;
+    std::string text = (tail[previous] == '[' ? "\n" : ",\n") + formatMoodRecord(record) + "\n]\n";
+
+    file.clear();
+    file.seekp(writeAt);
+    file.write(text.data(), static_cast<std::streamsize>(text.size()));
+    file.flush();
+    if (file) {
+        return true;
+    }
+
+    // A partial write (disk full, I/O error) would leave the array unclosed:
+    // cut the file back to its old size and put the original ending back
+    file.close();
+    std::error_code ec;
+    std::filesystem::resize_file(filename, static_cast<std::uintmax_t>(size), ec);
+    std::fstream restore(filename, std::ios::in | std::ios::out | std::ios::binary);
+    restore.seekp(writeAt);
+    restore.write(tail.data() + previous + 1, static_cast<std::streamsize>(tail.size() - previous - 1));
+    return false;
+}
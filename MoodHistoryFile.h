@@ -0,0 +1,121 @@
+#ifndef MOOD_HISTORY_FILE_H
+#define MOOD_HISTORY_FILE_H
+
+#include "MoodTracker.h"
+#include <fstream>
+#include <string>
+
+// A mood entry exactly as it is stored on disk
+struct MoodRecord {
+    std::string timestamp;      // "YYYY-MM-DD HH:MM:SS", sorts chronologically as text
+    int score = 0;              // Numerical score from 1-10
+    std::string description;    // Text description of mood
+
+    // Convert to and from the in-memory representation
+    static MoodRecord fromEntry(const MoodEntry& entry);
+    MoodEntry toEntry() const;
+
+    // Approximate heap footprint, used for memory budgeting
+    size_t memoryUsage() const;
+};
+
+// Records order by timestamp, then score, then description
+bool operator<(const MoodRecord& a, const MoodRecord& b);
+bool operator==(const MoodRecord& a, const MoodRecord& b);
+
+// Reads a mood history file one entry at a time, without loading it whole
+class MoodHistoryReader {
+private:
+    std::ifstream inFile;
+    bool failed = false;
+    bool finished = false;
+
+    // Skip whitespace and return the next character (EOF at end of stream)
+    int nextToken();
+
+    // Read one JSON object whose opening brace was already consumed
+    bool readObject(std::string& object);
+
+public:
+    // Open a history file; check good() afterwards
+    explicit MoodHistoryReader(const std::string& filename);
+
+    // Read the next record; false at the end of the file or on error
+    bool next(MoodRecord& record);
+
+    // True unless the file could not be opened or was malformed
+    bool good() const;
+};
+
+// Writes a mood history file one entry at a time, in saveMoodHistory's format
+class MoodHistoryWriter {
+private:
+    std::ofstream outFile;
+    bool empty = true;
+
+public:
+    // Create (or truncate) a history file; check good() afterwards
+    explicit MoodHistoryWriter(const std::string& filename);
+
+    // Append one record to the array
+    void write(const MoodRecord& record);
+
+    // Close the array; returns false if any write failed
+    bool finish();
+
+    // True while every write has succeeded
+    bool good() const;
+};
+
+// Advisory lock that serializes access to a history file across processes.
+//
+// Writers take it exclusively, readers shared. It locks a sidecar file
+// ("<history>.lock") rather than the history itself, so the history can
+// still be replaced by renaming a new file over it.
+//
+// Interactive sessions also hold a shared session lock ("<history>.session")
+// for as long as they are open, because they only expect other processes to
+// append. Anything that replaces the history wholesale (merge) must take it
+// exclusively first.
+class HistoryFileLock {
+private:
+#ifdef _WIN32
+    void* handle = nullptr;
+#else
+    int fd = -1;
+#endif
+    bool held = false;
+
+    struct LockFile {};
+
+    // Lock an arbitrary lock file, optionally without waiting
+    HistoryFileLock(LockFile, const std::string& lockFile, bool exclusive, bool wait);
+
+public:
+    // Block until the lock is held; check locked() afterwards
+    explicit HistoryFileLock(const std::string& historyFile, bool exclusive = true);
+    ~HistoryFileLock();
+
+    HistoryFileLock(const HistoryFileLock&) = delete;
+    HistoryFileLock& operator=(const HistoryFileLock&) = delete;
+
+    // Mark the history as open in an interactive session (waits while it
+    // is being replaced)
+    static HistoryFileLock forSession(const std::string& historyFile);
+
+    // Claim the history for replacing it; not locked() if a session has it open
+    static HistoryFileLock excludingSessions(const std::string& historyFile);
+
+    // True if the lock could be taken
+    bool locked() const;
+};
+
+// Format a single record the way saveMoodHistory lays out array elements
+std::string formatMoodRecord(const MoodRecord& record);
+
+// Append a record to a history file without parsing the existing entries.
+// Only the closing bracket at the end of the file is located and rewritten;
+// a missing or empty file is created. Callers should hold a HistoryFileLock.
+bool appendMoodRecord(const std::string& filename, const MoodRecord& record);
+
+#endif // MOOD_HISTORY_FILE_H
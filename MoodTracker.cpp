@@ -1,13 +1,184 @@
 #include "MoodTracker.h"
+#include "SentimentAnalyzer.h"
+#include "LocalDate.h"
+#include "Tokenizer.h"
 #include <nlohmann/json.hpp>
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <cctype>
 #include <iostream>
 #include <iomanip>
+#include <map>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+#include <filesystem>
 
 using json = nlohmann::json;
 
+namespace {
+
+// Words too common to say anything about a mood, such as "i", "and" or
+// "feel" (as folded by the tokenizer); numbers are skipped as well
+bool isStopWord(const std::string& word) {
+    static const std::unordered_set<std::string> stopWords = {
+        "a", "about", "after", "again", "all", "also", "am", "an", "and", "any", "are", "as", "at",
+        "be", "because", "been", "being", "bit", "but", "by", "can", "could", "did", "do", "does",
+        "doing", "don't", "feel", "feeling", "feels", "felt", "for", "from", "get", "getting", "got",
+        "had", "has", "have", "having", "he", "her", "him", "his", "how", "i", "i'd", "i'll", "i'm",
+        "i've", "if", "im", "in", "into", "is", "it", "it's", "its", "just", "kind", "kinda", "like",
+        "little", "me", "more", "most", "much", "my", "myself", "no", "not", "now", "of", "on",
+        "one", "or", "our", "out", "over", "pretty", "quite", "really", "she", "so", "some", "still",
+        "than", "that", "the", "their", "them", "then", "there", "they", "this", "to", "today",
+        "too", "up", "very", "was", "we", "were", "what", "when", "which", "while", "who", "why",
+        "will", "with", "would", "you", "your"
+    };
+    if (std::all_of(word.begin(), word.end(), [](unsigned char c) { return std::isdigit(c); })) {
+        return true;
+    }
+    return stopWords.count(word) > 0;
+}
+
+// Running totals for one rollup period while compacting
+struct RollupAccumulator {
+    int count = 0;
+    long long sum = 0;
+    int lowest = 0;
+    int highest = 0;
+    std::unordered_map<std::string, int> wordCounts;
+    
+    // Fold in one raw entry
+    void add(const MoodEntry& entry) {
+        lowest = count == 0 ? entry.score : std::min(lowest, entry.score);
+        highest = count == 0 ? entry.score : std::max(highest, entry.score);
+        ++count;
+        sum += entry.score;
+        for (const auto& word : extractWords(entry.description)) {
+            if (!isStopWord(word)) {
+                ++wordCounts[word];
+            }
+        }
+    }
+    
+    // Fold in an existing rollup (its word list is already truncated)
+    void add(const MoodRollup& rollup) {
+        if (rollup.count == 0) {
+            return;
+        }
+        lowest = count == 0 ? rollup.lowest : std::min(lowest, rollup.lowest);
+        highest = count == 0 ? rollup.highest : std::max(highest, rollup.highest);
+        count += rollup.count;
+        sum += rollup.sum;
+        for (const auto& [word, wordCount] : rollup.topWords) {
+            wordCounts[word] += wordCount;
+        }
+    }
+    
+    // Produce the rollup, keeping only the most frequent words
+    MoodRollup toRollup(long long startDay, int days, size_t topWords) const {
+        MoodRollup rollup;
+        rollup.startDay = startDay;
+        rollup.days = days;
+        rollup.count = count;
+        rollup.sum = sum;
+        rollup.lowest = lowest;
+        rollup.highest = highest;
+        rollup.topWords.assign(wordCounts.begin(), wordCounts.end());
+        std::sort(rollup.topWords.begin(), rollup.topWords.end(),
+                  [](const auto& a, const auto& b) {
+                      return a.second != b.second ? a.second > b.second : a.first < b.first;
+                  });
+        if (rollup.topWords.size() > topWords) {
+            rollup.topWords.resize(topWords);
+        }
+        return rollup;
+    }
+};
+
+// Fold expired entries into daily rollups and aged days into weekly ones.
+// Takes copies so it can run on a background thread.
+CompactionResult computeCompaction(std::vector<MoodEntry> expired,
+                                   std::vector<MoodRollup> daily,
+                                   std::vector<MoodRollup> weekly,
+                                   RetentionPolicy policy,
+                                   long long today,
+                                   unsigned generation) {
+    std::map<long long, RollupAccumulator> days;
+    for (const auto& rollup : daily) {
+        days[rollup.startDay].add(rollup);
+    }
+    for (const auto& entry : expired) {
+        days[localDayNumber(entry.timestamp)].add(entry);
+    }
+    
+    std::map<long long, RollupAccumulator> weeks;
+    for (const auto& rollup : weekly) {
+        weeks[rollup.startDay].add(rollup);
+    }
+    
+    CompactionResult result;
+    result.rawEntriesCompacted = expired.size();
+    result.generation = generation;
+    
+    // Days older than the daily tier's horizon move into their week
+    for (const auto& [day, totals] : days) {
+        if (policy.dailyDays > 0 && day <= today - policy.dailyDays) {
+            weeks[startOfWeek(day)].add(totals.toRollup(day, 1, policy.topWords));
+        } else {
+            result.dailyRollups.push_back(totals.toRollup(day, 1, policy.topWords));
+        }
+    }
+    for (const auto& [week, totals] : weeks) {
+        result.weeklyRollups.push_back(totals.toRollup(week, 7, policy.topWords));
+    }
+    return result;
+}
+
+// Fold a rollup's totals into a summary
+void addToSummary(MoodSummary& summary, long long& sum, const MoodRollup& rollup) {
+    if (rollup.count == 0) {
+        return;
+    }
+    if (summary.count == 0 || rollup.highest > summary.highest) {
+        summary.highest = rollup.highest;
+        summary.highestTime = startOfLocalDay(rollup.startDay);
+    }
+    if (summary.count == 0 || rollup.lowest < summary.lowest) {
+        summary.lowest = rollup.lowest;
+        summary.lowestTime = startOfLocalDay(rollup.startDay);
+    }
+    summary.count += rollup.count;
+    sum += rollup.sum;
+}
+
+// Replace a file with JSON content by writing a temporary file and renaming
+// it over the original, so an interrupted save leaves the old file intact
+bool replaceFileWithJson(const std::string& filename, const json& content) {
+    std::string tempFile = filename + ".tmp";
+    {
+        std::ofstream outFile(tempFile);
+        if (!outFile.is_open()) {
+            return false;
+        }
+        outFile << std::setw(4) << content << std::endl;
+        outFile.close();
+        if (outFile.fail()) {
+            return false;
+        }
+    }
+    
+    std::error_code ec;
+    std::filesystem::rename(tempFile, filename, ec);
+    if (ec) {
+        std::filesystem::remove(tempFile, ec);
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
 // MoodEntry constructor
 MoodEntry::MoodEntry(int score, const std::string& description) 
     : score(score), description(description), timestamp(std::chrono::system_clock::now()) {}
@@ -15,29 +186,100 @@ MoodEntry::MoodEntry(int score, const std::string& description)
 // MoodTracker constructor
 MoodTracker::MoodTracker() {}
 
-// Add a new mood entry to the history
-void MoodTracker::addMoodEntry(int score, const std::string& description) {
+// Add a new mood entry to the history and return any alerts it triggered
+std::vector<MoodAlert> MoodTracker::addMoodEntry(int score, const std::string& description) {
     // Create and add the new entry
     moodHistory.emplace_back(score, description);
+    if (sentimentAnalyzer) {
+        moodHistory.back().sentiment = sentimentAnalyzer->scoreText(description);
+    }
+    recordMoodWords(description, moodHistory.back().timestamp);
     
-    // Extract individual words from the description and add to the set
-    std::istringstream iss(description);
-    std::string word;
-    while (iss >> word) {
-        // Convert to lowercase for consistency
-        std::transform(word.begin(), word.end(), word.begin(), 
-                      [](unsigned char c){ return std::tolower(c); });
-        
-        // Remove any punctuation
-        word.erase(std::remove_if(word.begin(), word.end(), 
-                                 [](unsigned char c){ return std::ispunct(c); }), 
-                  word.end());
-        
-        // Add to set if it's not empty
-        if (!word.empty()) {
-            uniqueMoodWords.insert(word);
+    // Update the running alert state with just this entry
+    return anomalyDetector.observe(score, moodHistory.back().timestamp);
+}
+
+// Add an existing entry to the history, keeping its timestamp
+// (and scoring its sentiment, like a new entry)
+std::vector<MoodAlert> MoodTracker::addMoodEntry(const MoodEntry& entry) {
+    std::vector<MoodAlert> alerts = restoreEntry(entry);
+    if (sentimentAnalyzer) {
+        moodHistory.back().sentiment = sentimentAnalyzer->scoreText(entry.description);
+    }
+    return alerts;
+}
+
+// Add a stored entry without scoring it (rescoreSentiment does that in bulk)
+std::vector<MoodAlert> MoodTracker::restoreEntry(const MoodEntry& entry) {
+    moodHistory.push_back(entry);
+    recordMoodWords(entry.description, entry.timestamp);
+    return anomalyDetector.observe(entry.score, entry.timestamp);
+}
+
+// Replace the alert rules and re-evaluate them over the history
+void MoodTracker::setAlertRules(const std::vector<AlertRule>& rules) {
+    anomalyDetector.setRules(rules);
+    for (const auto& entry : moodHistory) {
+        anomalyDetector.observe(entry.score, entry.timestamp);
+    }
+}
+
+// Load alert rules from a JSON file and re-evaluate them over the history
+bool MoodTracker::loadAlertRules(const std::string& filename) {
+    AnomalyDetector loaded;
+    if (!loaded.loadRulesFromFile(filename)) {
+        return false;
+    }
+    setAlertRules(loaded.getRules());
+    return true;
+}
+
+// Get the active alert rules
+const std::vector<AlertRule>& MoodTracker::getAlertRules() const {
+    return anomalyDetector.getRules();
+}
+
+// Count the words of a description used at a given time, skipping stop words
+void MoodTracker::recordMoodWords(const std::string& description,
+                                  const std::chrono::system_clock::time_point& time) {
+    long long day = localDayNumber(time);
+    for (const auto& word : extractWords(description)) {
+        if (!isStopWord(word)) {
+            moodWords.addWord(word, day);
+        }
+    }
+}
+
+// Recount the words of the rollups and the raw history.
+// Rolled-up entries only contribute the words their rollup kept.
+void MoodTracker::recountMoodWords() {
+    moodWords.clear();
+    for (const auto* tier : {&weeklyRollups, &dailyRollups}) {
+        for (const auto& rollup : *tier) {
+            for (const auto& [word, wordCount] : rollup.topWords) {
+                // Rollups saved before stop words were skipped may still hold them
+                if (!isStopWord(word)) {
+                    moodWords.addWord(word, rollup.startDay, wordCount);
+                }
+            }
         }
     }
+    for (const auto& entry : moodHistory) {
+        recordMoodWords(entry.description, entry.timestamp);
+    }
+}
+
+// Score the sentiment of new entries with this analyzer (nullptr to disable)
+void MoodTracker::setSentimentAnalyzer(const SentimentAnalyzer* analyzer) {
+    sentimentAnalyzer = analyzer;
+}
+
+// Rescore the whole history in parallel, caching scores in cacheFile
+bool MoodTracker::rescoreSentiment(const std::string& cacheFile) {
+    if (!sentimentAnalyzer) {
+        return false;
+    }
+    return sentimentAnalyzer->scoreEntriesCached(moodHistory, cacheFile);
 }
 
 // Get the most recent mood entry
@@ -53,14 +295,21 @@ const std::vector<MoodEntry>& MoodTracker::getMoodHistory() const {
     return moodHistory;
 }
 
-// Get all unique mood words that have been used
-const std::set<std::string>& MoodTracker::getUniqueMoodWords() const {
-    return uniqueMoodWords;
+// Get the most used mood words with their (estimated) counts, most used first
+std::vector<std::pair<std::string, int>> MoodTracker::getTopMoodWords(size_t count) const {
+    return moodWords.getTopWords(count);
 }
 
-// Get average mood score over time
+// Get the most used mood words in the calendar month containing a time
+std::vector<std::pair<std::string, int>> MoodTracker::getTopMoodWordsForMonth(
+    const std::chrono::system_clock::time_point& when, size_t count) const {
+    return moodWords.getTopWordsForMonth(localDayNumber(when), count);
+}
+
+// Get average mood score over time (including rolled-up entries)
 double MoodTracker::getAverageMoodScore() const {
-    if (moodHistory.empty()) {
+    size_t count = getTotalEntryCount();
+    if (count == 0) {
         return 5.0; // Default neutral score if no entries
     }
     
@@ -68,12 +317,308 @@ double MoodTracker::getAverageMoodScore() const {
     for (const auto& entry : moodHistory) {
         sum += entry.score;
     }
+    for (const auto* tier : {&dailyRollups, &weeklyRollups}) {
+        for (const auto& rollup : *tier) {
+            sum += rollup.sum;
+        }
+    }
     
-    return sum / moodHistory.size();
+    return sum / count;
+}
+
+// Get the number of entries ever recorded, raw or rolled up
+size_t MoodTracker::getTotalEntryCount() const {
+    size_t count = moodHistory.size();
+    for (const auto* tier : {&dailyRollups, &weeklyRollups}) {
+        for (const auto& rollup : *tier) {
+            count += rollup.count;
+        }
+    }
+    return count;
+}
+
+// Summarize every entry between two times, across all tiers.
+// Rollups count if the day (or week) they start on falls in the range.
+MoodSummary MoodTracker::summarizeRange(const std::chrono::system_clock::time_point& from,
+                                        const std::chrono::system_clock::time_point& to) const {
+    return summarize(from, to, localDayNumber(from), localDayNumber(to));
 }
 
-// Save mood history to a file
+// Summarize every entry ever recorded, across all tiers
+MoodSummary MoodTracker::summarizeAll() const {
+    return summarize(std::chrono::system_clock::time_point::min(),
+                     std::chrono::system_clock::time_point::max(),
+                     std::numeric_limits<long long>::min(),
+                     std::numeric_limits<long long>::max());
+}
+
+// Summarize raw entries in [from, to] and rollups starting in [fromDay, toDay]
+MoodSummary MoodTracker::summarize(const std::chrono::system_clock::time_point& from,
+                                   const std::chrono::system_clock::time_point& to,
+                                   long long fromDay, long long toDay) const {
+    MoodSummary summary;
+    long long sum = 0;
+    
+    // Oldest tiers first, so ties report the earliest occurrence
+    for (const auto* tier : {&weeklyRollups, &dailyRollups}) {
+        for (const auto& rollup : *tier) {
+            if (rollup.startDay >= fromDay && rollup.startDay <= toDay) {
+                addToSummary(summary, sum, rollup);
+            }
+        }
+    }
+    
+    for (const auto& entry : moodHistory) {
+        if (entry.timestamp < from || entry.timestamp > to) {
+            continue;
+        }
+        if (summary.count == 0 || entry.score > summary.highest) {
+            summary.highest = entry.score;
+            summary.highestTime = entry.timestamp;
+        }
+        if (summary.count == 0 || entry.score < summary.lowest) {
+            summary.lowest = entry.score;
+            summary.lowestTime = entry.timestamp;
+        }
+        ++summary.count;
+        sum += entry.score;
+    }
+    
+    if (summary.count > 0) {
+        summary.average = static_cast<double>(sum) / summary.count;
+    }
+    return summary;
+}
+
+// Get per-day summaries between two times, ordered by day
+std::vector<MoodRollup> MoodTracker::getDailySummaries(const std::chrono::system_clock::time_point& from,
+                                                       const std::chrono::system_clock::time_point& to) const {
+    long long fromDay = localDayNumber(from);
+    long long toDay = localDayNumber(to);
+    std::map<long long, RollupAccumulator> days;
+    std::vector<MoodRollup> summaries;
+    
+    for (const auto* tier : {&weeklyRollups, &dailyRollups}) {
+        for (const auto& rollup : *tier) {
+            if (rollup.startDay + rollup.days - 1 < fromDay || rollup.startDay > toDay) {
+                continue;
+            }
+            if (rollup.days == 1) {
+                days[rollup.startDay].add(rollup);
+            } else {
+                summaries.push_back(rollup);
+            }
+        }
+    }
+    for (const auto& entry : moodHistory) {
+        if (entry.timestamp >= from && entry.timestamp <= to) {
+            days[localDayNumber(entry.timestamp)].add(entry);
+        }
+    }
+    
+    for (const auto& [day, totals] : days) {
+        summaries.push_back(totals.toRollup(day, 1, retentionPolicy.topWords));
+    }
+    std::sort(summaries.begin(), summaries.end(),
+              [](const MoodRollup& a, const MoodRollup& b) { return a.startDay < b.startDay; });
+    return summaries;
+}
+
+// Get the rolled-up tiers
+const std::vector<MoodRollup>& MoodTracker::getDailyRollups() const {
+    return dailyRollups;
+}
+
+const std::vector<MoodRollup>& MoodTracker::getWeeklyRollups() const {
+    return weeklyRollups;
+}
+
+// Set how long entries stay in each tier
+void MoodTracker::setRetentionPolicy(const RetentionPolicy& policy) {
+    retentionPolicy = policy;
+}
+
+// Load the retention policy from a JSON file
+bool MoodTracker::loadRetentionPolicy(const std::string& filename) {
+    try {
+        // Open the file
+        std::ifstream inFile(filename);
+        if (!inFile.is_open()) {
+            return false;
+        }
+        
+        // Parse JSON
+        json policyJson;
+        inFile >> policyJson;
+        
+        RetentionPolicy policy;
+        policy.rawDays = policyJson.value("rawDays", 0);
+        policy.dailyDays = policyJson.value("dailyDays", 0);
+        policy.topWords = policyJson.value("topWords", policy.topWords);
+        
+        // Daily rollups must cover at least the days the raw tier has expired
+        if (policy.rawDays < 0 || policy.dailyDays < 0 ||
+            (policy.dailyDays > 0 && policy.dailyDays < policy.rawDays)) {
+            return false;
+        }
+        
+        retentionPolicy = policy;
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+// Get the retention policy
+const RetentionPolicy& MoodTracker::getRetentionPolicy() const {
+    return retentionPolicy;
+}
+
+// Start rolling up expired entries on a background thread.
+// Only the expired prefix of the history is copied; entries appended while
+// the compaction runs are unaffected when it's applied.
+std::future<CompactionResult> MoodTracker::startCompaction(const std::chrono::system_clock::time_point& now) const {
+    long long today = localDayNumber(now);
+    
+    std::vector<MoodEntry> expired;
+    if (retentionPolicy.rawDays > 0) {
+        long long lastExpiredDay = today - retentionPolicy.rawDays;
+        for (const auto& entry : moodHistory) {
+            if (localDayNumber(entry.timestamp) > lastExpiredDay) {
+                break;
+            }
+            expired.push_back(entry);
+        }
+    }
+    
+    return std::async(std::launch::async, computeCompaction, std::move(expired),
+                      dailyRollups, weeklyRollups, retentionPolicy, today, generation);
+}
+
+// Apply a finished compaction; false if the history was reloaded meanwhile
+bool MoodTracker::applyCompaction(const CompactionResult& result) {
+    if (result.generation != generation || result.rawEntriesCompacted > moodHistory.size()) {
+        return false;
+    }
+    
+    moodHistory.erase(moodHistory.begin(), moodHistory.begin() + result.rawEntriesCompacted);
+    dailyRollups = result.dailyRollups;
+    weeklyRollups = result.weeklyRollups;
+    ++generation;
+    return true;
+}
+
+// Roll up expired entries right away
+void MoodTracker::compactHistory(const std::chrono::system_clock::time_point& now) {
+    applyCompaction(startCompaction(now).get());
+}
+
+// Read a rollups file into its two tiers without touching any tracker
+bool MoodTracker::parseRollups(const std::string& filename, std::vector<MoodRollup>& daily,
+                               std::vector<MoodRollup>& weekly) {
+    try {
+        // Open the file
+        std::ifstream inFile(filename);
+        if (!inFile.is_open()) {
+            return false;
+        }
+        
+        // Parse JSON
+        json rollupsJson;
+        inFile >> rollupsJson;
+        
+        std::vector<MoodRollup> loaded[2];
+        const char* keys[2] = {"daily", "weekly"};
+        for (int t = 0; t < 2; ++t) {
+            for (const auto& rollupJson : rollupsJson.at(keys[t])) {
+                MoodRollup rollup;
+                if (!parseDayNumber(rollupJson.at("start"), rollup.startDay)) {
+                    return false;
+                }
+                rollup.days = t == 0 ? 1 : 7;
+                rollup.count = rollupJson.at("count");
+                rollup.sum = rollupJson.at("sum");
+                rollup.lowest = rollupJson.at("lowest");
+                rollup.highest = rollupJson.at("highest");
+                for (const auto& wordJson : rollupJson.at("topWords")) {
+                    rollup.topWords.emplace_back(wordJson.at(0), wordJson.at(1));
+                }
+                loaded[t].push_back(rollup);
+            }
+        }
+        
+        daily = std::move(loaded[0]);
+        weekly = std::move(loaded[1]);
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+// Save or load only the rolled-up tiers
+bool MoodTracker::saveRollups(const std::string& filename) const {
+    try {
+        json rollupsJson = {{"daily", json::array()}, {"weekly", json::array()}};
+        for (const auto& [key, tier] : {std::make_pair("daily", &dailyRollups),
+                                        std::make_pair("weekly", &weeklyRollups)}) {
+            for (const auto& rollup : *tier) {
+                json wordsJson = json::array();
+                for (const auto& [word, count] : rollup.topWords) {
+                    wordsJson.push_back({word, count});
+                }
+                rollupsJson[key].push_back({
+                    {"start", formatDayNumber(rollup.startDay)},
+                    {"count", rollup.count},
+                    {"sum", rollup.sum},
+                    {"lowest", rollup.lowest},
+                    {"highest", rollup.highest},
+                    {"topWords", wordsJson}
+                });
+            }
+        }
+        
+        return replaceFileWithJson(filename, rollupsJson);
+    } catch (...) {
+        return false;
+    }
+}
+
+bool MoodTracker::loadRollups(const std::string& filename) {
+    std::vector<MoodRollup> daily;
+    std::vector<MoodRollup> weekly;
+    if (!parseRollups(filename, daily, weekly)) {
+        return false;
+    }
+    
+    dailyRollups = std::move(daily);
+    weeklyRollups = std::move(weekly);
+    ++generation;
+    
+    // Words from rolled-up entries still count as used
+    recountMoodWords();
+    return true;
+}
+
+// File that holds the rollups for a history file
+std::string MoodTracker::rollupFileFor(const std::string& historyFile) {
+    const std::string extension = ".json";
+    if (historyFile.size() >= extension.size() &&
+        historyFile.compare(historyFile.size() - extension.size(), extension.size(), extension) == 0) {
+        return historyFile.substr(0, historyFile.size() - extension.size()) + ".rollups.json";
+    }
+    return historyFile + ".rollups.json";
+}
+
+// Save mood history to a file (rollups go to rollupFileFor(filename))
 bool MoodTracker::saveMoodHistory(const std::string& filename) const {
+    // Rollups go first: if saving is interrupted between the two files, a
+    // compacted day is counted twice on the next load rather than lost.
+    // Each file is replaced whole, never left half written.
+    if ((!dailyRollups.empty() || !weeklyRollups.empty()) &&
+        !saveRollups(rollupFileFor(filename))) {
+        return false;
+    }
+    
     try {
         // Create JSON array to store entries
         json historyJson = json::array();
@@ -81,8 +626,9 @@ bool MoodTracker::saveMoodHistory(const std::string& filename) const {
         for (const auto& entry : moodHistory) {
             // Convert timestamp to string
             auto timeT = std::chrono::system_clock::to_time_t(entry.timestamp);
+            std::tm local = toLocalTime(timeT);
             std::stringstream ss;
-            ss << std::put_time(std::localtime(&timeT), "%Y-%m-%d %H:%M:%S");
+            ss << std::put_time(&local, "%Y-%m-%d %H:%M:%S");
             
             // Create JSON object for this entry
             json entryJson = {
@@ -95,19 +641,15 @@ bool MoodTracker::saveMoodHistory(const std::string& filename) const {
         }
         
         // Write JSON to file
-        std::ofstream outFile(filename);
-        if (!outFile.is_open()) {
-            return false;
-        }
-        
-        outFile << std::setw(4) << historyJson << std::endl;
-        return true;
+        return replaceFileWithJson(filename, historyJson);
     } catch (...) {
         return false;
     }
 }
 
-// Load mood history from a file
+// Load mood history from a file (and its rollups, if any).
+// Both files are parsed before anything is replaced, so a failed load
+// leaves the tracker as it was.
 bool MoodTracker::loadMoodHistory(const std::string& filename) {
     try {
         // Open the file
@@ -120,45 +662,43 @@ bool MoodTracker::loadMoodHistory(const std::string& filename) {
         json historyJson;
         inFile >> historyJson;
         
-        // Clear existing data
-        moodHistory.clear();
-        uniqueMoodWords.clear();
-        
         // Load entries from JSON
+        std::vector<MoodEntry> entries;
         for (const auto& entryJson : historyJson) {
-            int score = entryJson["score"];
-            std::string description = entryJson["description"];
+            int score = entryJson.at("score");
+            std::string description = entryJson.at("description");
             
             // Create a new entry
             MoodEntry entry(score, description);
             
             // Parse timestamp (simplified - we're not restoring the exact timestamp)
-            std::string timeStr = entryJson["timestamp"];
+            std::string timeStr = entryJson.at("timestamp");
             std::tm tm = {};
             std::istringstream ss(timeStr);
             ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
             entry.timestamp = std::chrono::system_clock::from_time_t(std::mktime(&tm));
             
-            // Add to history
-            moodHistory.push_back(entry);
-            
-            // Process words for the unique set
-            std::istringstream wordStream(description);
-            std::string word;
-            while (wordStream >> word) {
-                // Convert to lowercase
-                std::transform(word.begin(), word.end(), word.begin(), 
-                              [](unsigned char c){ return std::tolower(c); });
-                
-                // Remove punctuation
-                word.erase(std::remove_if(word.begin(), word.end(), 
-                                         [](unsigned char c){ return std::ispunct(c); }), 
-                          word.end());
-                
-                if (!word.empty()) {
-                    uniqueMoodWords.insert(word);
-                }
-            }
+            entries.push_back(entry);
+        }
+        
+        // Older entries may live on as rollups
+        std::vector<MoodRollup> daily;
+        std::vector<MoodRollup> weekly;
+        std::string rollupFile = rollupFileFor(filename);
+        if (std::filesystem::exists(rollupFile) && !parseRollups(rollupFile, daily, weekly)) {
+            return false;
+        }
+        
+        // Replace existing data, counting the rollups' words before the raw entries'
+        moodHistory.clear();
+        anomalyDetector.reset();
+        dailyRollups = std::move(daily);
+        weeklyRollups = std::move(weekly);
+        ++generation;
+        recountMoodWords();
+        
+        for (const auto& entry : entries) {
+            restoreEntry(entry);
         }
         
         return true;
@@ -3,29 +3,110 @@
 
 #include <vector>
 #include <string>
-#include <set>
 #include <chrono>
+#include <future>
+#include <utility>
+#include "AnomalyDetector.h"
+#include "WordFrequency.h"
+
+class SentimentAnalyzer;
 
 // Structure to store mood entries
 struct MoodEntry {
     int score;                                              // Numerical score from 1-10
     std::string description;                                // Text description of mood
     std::chrono::system_clock::time_point timestamp;        // When the entry was recorded
+    double sentiment = 0.0;                                 // Tone of the description, -1 to +1
     
     // Constructor for easy creation
     MoodEntry(int score, const std::string& description);
 };
 
+// Aggregate of one day's or one week's entries, kept once the raw entries expire
+struct MoodRollup {
+    long long startDay = 0;                                 // First local day covered (see LocalDate.h)
+    int days = 1;                                           // 1 for daily, 7 for weekly rollups
+    int count = 0;                                          // Number of entries
+    long long sum = 0;                                      // Sum of their scores
+    int lowest = 0;                                         // Lowest score
+    int highest = 0;                                        // Highest score
+    std::vector<std::pair<std::string, int>> topWords;      // Most used words, most frequent first
+};
+
+// How long each tier of history is kept (0 days = forever)
+struct RetentionPolicy {
+    int rawDays = 0;                                        // Keep individual entries this many days
+    int dailyDays = 0;                                      // Then daily rollups up to this age, weekly after
+    size_t topWords = 5;                                    // Words remembered per rollup
+};
+
+// Summary of every entry in a time range, across all tiers
+struct MoodSummary {
+    size_t count = 0;
+    double average = 5.0;                                   // Neutral if there are no entries
+    int highest = 0;
+    int lowest = 0;
+    std::chrono::system_clock::time_point highestTime;      // Day start for rolled-up extremes
+    std::chrono::system_clock::time_point lowestTime;
+};
+
+// Outcome of a compaction pass, computed in the background and applied afterwards
+struct CompactionResult {
+    size_t rawEntriesCompacted = 0;                         // Leading history entries folded into rollups
+    std::vector<MoodRollup> dailyRollups;                   // Replacement daily tier
+    std::vector<MoodRollup> weeklyRollups;                  // Replacement weekly tier
+    unsigned generation = 0;                                // Tracker state it was computed from
+};
+
 class MoodTracker {
 private:
     std::vector<MoodEntry> moodHistory;                     // Vector to store mood history
-    std::set<std::string> uniqueMoodWords;                  // Set to track unique mood descriptors
+    WordFrequencyTracker moodWords;                         // How often each mood word was used
+    const SentimentAnalyzer* sentimentAnalyzer = nullptr;   // Scores new descriptions if set
+    AnomalyDetector anomalyDetector;                        // Watches for streaks and sudden drops
+    std::vector<MoodRollup> dailyRollups;                   // Expired entries summarized per day
+    std::vector<MoodRollup> weeklyRollups;                  // Older days summarized per week
+    RetentionPolicy retentionPolicy;                        // When entries move between tiers
+    unsigned generation = 0;                                // Bumped whenever the tiers are replaced
+    
+    // Add a stored entry without scoring it (rescoreSentiment does that in bulk)
+    std::vector<MoodAlert> restoreEntry(const MoodEntry& entry);
+    
+    // Count the words of a description used at a given time, skipping stop words
+    void recordMoodWords(const std::string& description, const std::chrono::system_clock::time_point& time);
+    
+    // Recount the words of the rollups and the raw history
+    void recountMoodWords();
+    
+    // Summarize raw entries in [from, to] and rollups starting in [fromDay, toDay]
+    MoodSummary summarize(const std::chrono::system_clock::time_point& from,
+                          const std::chrono::system_clock::time_point& to,
+                          long long fromDay, long long toDay) const;
 
 public:
     MoodTracker();
     
-    // Add a new mood entry to the history
-    void addMoodEntry(int score, const std::string& description);
+    // Add a new mood entry to the history and return any alerts it triggered
+    std::vector<MoodAlert> addMoodEntry(int score, const std::string& description);
+    
+    // Add an existing entry to the history, keeping its timestamp
+    // (and scoring its sentiment, like a new entry)
+    std::vector<MoodAlert> addMoodEntry(const MoodEntry& entry);
+    
+    // Replace the alert rules and re-evaluate them over the history
+    void setAlertRules(const std::vector<AlertRule>& rules);
+    
+    // Load alert rules from a JSON file and re-evaluate them over the history
+    bool loadAlertRules(const std::string& filename);
+    
+    // Get the active alert rules
+    const std::vector<AlertRule>& getAlertRules() const;
+    
+    // Score the sentiment of new entries with this analyzer (nullptr to disable)
+    void setSentimentAnalyzer(const SentimentAnalyzer* analyzer);
+    
+    // Rescore the whole history in parallel, caching scores in cacheFile
+    bool rescoreSentiment(const std::string& cacheFile);
     
     // Get the most recent mood entry
     MoodEntry getLatestMood() const;
@@ -33,17 +114,72 @@ public:
     // Get the entire mood history
     const std::vector<MoodEntry>& getMoodHistory() const;
     
-    // Get all unique mood words that have been used
-    const std::set<std::string>& getUniqueMoodWords() const;
+    // Get the most used mood words with their (estimated) counts, most used first
+    std::vector<std::pair<std::string, int>> getTopMoodWords(size_t count) const;
+    
+    // Get the most used mood words in the calendar month containing a time;
+    // only the last 12 months are tracked separately
+    std::vector<std::pair<std::string, int>> getTopMoodWordsForMonth(
+        const std::chrono::system_clock::time_point& when, size_t count) const;
     
-    // Get average mood score over time
+    // Get average mood score over time (including rolled-up entries)
     double getAverageMoodScore() const;
     
-    // Save mood history to a file
+    // Get the number of entries ever recorded, raw or rolled up
+    size_t getTotalEntryCount() const;
+    
+    // Summarize every entry between two times, across all tiers
+    MoodSummary summarizeRange(const std::chrono::system_clock::time_point& from,
+                               const std::chrono::system_clock::time_point& to) const;
+    
+    // Summarize every entry ever recorded, across all tiers
+    MoodSummary summarizeAll() const;
+    
+    // Get per-day summaries between two times, ordered by day; days that are
+    // only kept as weekly rollups appear as one summary per week
+    std::vector<MoodRollup> getDailySummaries(const std::chrono::system_clock::time_point& from,
+                                              const std::chrono::system_clock::time_point& to) const;
+    
+    // Get the rolled-up tiers
+    const std::vector<MoodRollup>& getDailyRollups() const;
+    const std::vector<MoodRollup>& getWeeklyRollups() const;
+    
+    // Set how long entries stay in each tier
+    void setRetentionPolicy(const RetentionPolicy& policy);
+    
+    // Load the retention policy from a JSON file
+    bool loadRetentionPolicy(const std::string& filename);
+    
+    // Get the retention policy
+    const RetentionPolicy& getRetentionPolicy() const;
+    
+    // Start rolling up expired entries on a background thread
+    std::future<CompactionResult> startCompaction(
+        const std::chrono::system_clock::time_point& now = std::chrono::system_clock::now()) const;
+    
+    // Apply a finished compaction; false if the history was reloaded meanwhile
+    bool applyCompaction(const CompactionResult& result);
+    
+    // Roll up expired entries right away
+    void compactHistory(const std::chrono::system_clock::time_point& now = std::chrono::system_clock::now());
+    
+    // Save mood history to a file (rollups go to rollupFileFor(filename))
     bool saveMoodHistory(const std::string& filename) const;
     
-    // Load mood history from a file
+    // Load mood history from a file (and its rollups, if any);
+    // the tracker is left unchanged if either file can't be read
     bool loadMoodHistory(const std::string& filename);
+    
+    // Save or load only the rolled-up tiers
+    bool saveRollups(const std::string& filename) const;
+    bool loadRollups(const std::string& filename);
+    
+    // Read a rollups file into its two tiers without touching any tracker
+    static bool parseRollups(const std::string& filename, std::vector<MoodRollup>& daily,
+                             std::vector<MoodRollup>& weekly);
+    
+    // File that holds the rollups for a history file
+    static std::string rollupFileFor(const std::string& historyFile);
 };
 
 #endif // MOOD_TRACKER_H
@@ -1,11 +1,163 @@
 #include "ResourceMap.h"
+#include "Tokenizer.h"
 #include <nlohmann/json.hpp>
 #include <fstream>
 #include <iostream>
 #include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <numeric>
+#include <queue>
+#include <unordered_map>
 
 using json = nlohmann::json;
 
+namespace {
+
+// Weights used when ranking recommendation candidates
+const double kKeywordHitWeight = 2.0;           // Per description word matching a mood keyword
+const double kScoreProximityWeight = 3.0;       // For a resource mapped to the exact score
+const int kScoreProximityRadius = 2;            // How many score buckets away still count
+const double kSentimentWeight = 3.0;            // For a strongly toned description's score bucket
+const double kSentimentThreshold = 0.3;         // Weaker tones don't influence the ranking
+const double kExposurePenalty = 1.5;            // Per (decayed) recent exposure
+const double kExposureHalfLifeHours = 24.0;     // Exposure halves every day
+const double kExposureFloor = 0.01;             // Forget exposures smaller than this
+const int kShownScoreMax = 4;                   // Entries scored this low get suggestions
+const double kShownSentimentMax = -0.5;         // So do entries with a tone this negative
+
+// Resources are deduplicated by a hash of their URL
+size_t resourceId(const Resource& resource) {
+    return std::hash<std::string>{}(resource.url);
+}
+
+// A deduplicated candidate accumulated while scoring one entry
+struct CandidateSlot {
+    const Resource* resource;
+    double score;
+    size_t order;               // First-seen position, used to break ties
+};
+
+// True if candidate a should be ranked above candidate b
+bool outranks(const CandidateSlot& a, const CandidateSlot& b) {
+    if (a.score != b.score) {
+        return a.score > b.score;
+    }
+    return a.order < b.order;
+}
+
+// Orders the bounded heap so the weakest kept candidate sits on top
+struct WeakestOnTop {
+    bool operator()(const CandidateSlot& a, const CandidateSlot& b) const {
+        return outranks(a, b);
+    }
+};
+
+// Scratch state reused across every entry scored in a batch
+class CandidateTable {
+public:
+    // Drop all candidates but keep allocated storage
+    void clear() {
+        slots.clear();
+        slotById.clear();
+    }
+
+    // Add weight to a resource, creating its slot on first sight
+    void add(const Resource* resource, double weight) {
+        size_t id = resourceId(*resource);
+        // Probe past hash collisions so distinct URLs never merge
+        while (true) {
+            auto it = slotById.find(id);
+            if (it == slotById.end()) {
+                slotById.emplace(id, slots.size());
+                slots.push_back({resource, weight, slots.size()});
+                return;
+            }
+            CandidateSlot& slot = slots[it->second];
+            if (slot.resource->url == resource->url) {
+                slot.score += weight;
+                return;
+            }
+            ++id;
+        }
+    }
+
+    std::vector<CandidateSlot> slots;
+    std::unordered_map<size_t, size_t> slotById;
+};
+
+// Decayed count of how often each resource was recently surfaced to the user
+class ExposureTracker {
+public:
+    // Decay all exposures forward to the given time
+    void advanceTo(const std::chrono::system_clock::time_point& time) {
+        if (!started) {
+            started = true;
+            now = time;
+            return;
+        }
+        if (time <= now) {
+            return;
+        }
+        std::chrono::duration<double, std::ratio<3600>> elapsed = time - now;
+        double factor = std::exp2(-elapsed.count() / kExposureHalfLifeHours);
+        for (auto it = exposure.begin(); it != exposure.end(); ) {
+            it->second *= factor;
+            if (it->second < kExposureFloor) {
+                it = exposure.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        now = time;
+    }
+
+    // Record that a resource was shown to the user
+    void record(const Resource& resource) {
+        exposure[resourceId(resource)] += 1.0;
+    }
+
+    // Current decayed exposure of a resource
+    double get(const Resource& resource) const {
+        auto it = exposure.find(resourceId(resource));
+        return it != exposure.end() ? it->second : 0.0;
+    }
+
+private:
+    std::unordered_map<size_t, double> exposure;
+    std::chrono::system_clock::time_point now;
+    bool started = false;
+};
+
+// Rank a table's candidates after the exposure penalty, keeping the k best in
+// a bounded heap instead of sorting everything; returns them best first
+std::vector<CandidateSlot> rankCandidates(const CandidateTable& table, const ExposureTracker& exposure,
+                                          size_t k) {
+    std::priority_queue<CandidateSlot, std::vector<CandidateSlot>, WeakestOnTop> best;
+    for (auto slot : table.slots) {
+        slot.score -= kExposurePenalty * exposure.get(*slot.resource);
+        if (best.size() < k) {
+            best.push(slot);
+        } else if (outranks(slot, best.top())) {
+            best.pop();
+            best.push(slot);
+        }
+    }
+    
+    // Drain weakest-first, then reverse into ranked order
+    std::vector<CandidateSlot> ranked;
+    ranked.reserve(best.size());
+    while (!best.empty()) {
+        ranked.push_back(best.top());
+        best.pop();
+    }
+    std::reverse(ranked.begin(), ranked.end());
+    return ranked;
+}
+
+} // namespace
+
 // Resource constructor
 Resource::Resource(const std::string& title, const std::string& url, const std::string& description)
     : title(title), url(url), description(description) {}
@@ -106,12 +258,8 @@ bool ResourceMap::loadResourcesFromFile(const std::string& filename) {
 
 // Add a resource for a specific mood keyword
 void ResourceMap::addResourceForMood(const std::string& mood, const Resource& resource) {
-    // Convert mood to lowercase for consistency
-    std::string moodLower = mood;
-    std::transform(moodLower.begin(), moodLower.end(), moodLower.begin(),
-                  [](unsigned char c){ return std::tolower(c); });
-    
-    moodToResources[moodLower].push_back(resource);
+    // Case-fold the mood, as descriptions are matched case-folded
+    moodToResources[foldCase(mood)].push_back(resource);
 }
 
 // Add a resource for a specific mood score
@@ -124,13 +272,8 @@ void ResourceMap::addResourceForScore(int score, const Resource& resource) {
 
 // Get resources based on mood description
 std::vector<Resource> ResourceMap::getResourcesForMood(const std::string& mood) const {
-    // Convert mood to lowercase
-    std::string moodLower = mood;
-    std::transform(moodLower.begin(), moodLower.end(), moodLower.begin(),
-                  [](unsigned char c){ return std::tolower(c); });
-    
-    // Look for exact match
-    auto it = moodToResources.find(moodLower);
+    // Look for exact match, ignoring case
+    auto it = moodToResources.find(foldCase(mood));
     if (it != moodToResources.end()) {
         return it->second;
     }
@@ -153,3 +296,128 @@ std::vector<Resource> ResourceMap::getResourcesForScore(int score) const {
 std::map<std::string, std::vector<Resource>> ResourceMap::getAllMoodResources() const {
     return moodToResources;
 }
+
+// Collect every resource relevant to an entry along with its base weight
+void ResourceMap::collectCandidates(const MoodEntry& entry,
+                                    std::vector<std::pair<const Resource*, double>>& candidates) const {
+    candidates.clear();
+    
+    // Keyword hits: every description word that names a mood adds weight
+    for (const auto& word : extractWords(entry.description)) {
+        auto it = moodToResources.find(word);
+        if (it != moodToResources.end()) {
+            for (const auto& resource : it->second) {
+                candidates.emplace_back(&resource, kKeywordHitWeight);
+            }
+        }
+    }
+    
+    // Score proximity: nearby score buckets count, closer ones more
+    for (int offset = -kScoreProximityRadius; offset <= kScoreProximityRadius; ++offset) {
+        auto it = scoreToResources.find(entry.score + offset);
+        if (it != scoreToResources.end()) {
+            double weight = kScoreProximityWeight / (1 + std::abs(offset));
+            for (const auto& resource : it->second) {
+                candidates.emplace_back(&resource, weight);
+            }
+        }
+    }
+    
+    // Sentiment: a clearly toned description also counts as the score it reads like,
+    // so "hopeless" text surfaces low-score resources even when the score is high
+    if (std::abs(entry.sentiment) >= kSentimentThreshold) {
+        int textScore = std::clamp(static_cast<int>(std::lround(5.5 + 4.5 * entry.sentiment)), 1, 10);
+        for (int offset = -kScoreProximityRadius; offset <= kScoreProximityRadius; ++offset) {
+            auto it = scoreToResources.find(textScore + offset);
+            if (it != scoreToResources.end()) {
+                double weight = kSentimentWeight * std::abs(entry.sentiment) / (1 + std::abs(offset));
+                for (const auto& resource : it->second) {
+                    candidates.emplace_back(&resource, weight);
+                }
+            }
+        }
+    }
+}
+
+// Whether the app suggests resources for an entry on its own (alerts aside)
+bool ResourceMap::suggestsResources(const MoodEntry& entry) {
+    return entry.score <= kShownScoreMax || entry.sentiment <= kShownSentimentMax;
+}
+
+// Recommend the top k resources for a mood entry
+std::vector<RecommendedResource> ResourceMap::recommendResources(const MoodEntry& entry,
+                                                                 const std::vector<MoodEntry>& history,
+                                                                 size_t k) const {
+    return recommendResourcesForEntries({entry}, history, k).front();
+}
+
+// Recommend the top k resources for each entry, scoring all of them in one pass.
+// The history is expected in chronological order, as MoodTracker keeps it; only
+// history entries recorded before an entry count towards its exposure penalty,
+// and only with the resources the app would actually have shown for them.
+std::vector<std::vector<RecommendedResource>> ResourceMap::recommendResourcesForEntries(
+    const std::vector<MoodEntry>& entries,
+    const std::vector<MoodEntry>& history,
+    size_t k) const {
+    std::vector<std::vector<RecommendedResource>> results(entries.size());
+    if (entries.empty() || k == 0) {
+        return results;
+    }
+    
+    // Visit entries in time order so one sweep over the history suffices
+    std::vector<size_t> order(entries.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&entries](size_t a, size_t b) {
+        return entries[a].timestamp < entries[b].timestamp;
+    });
+    
+    std::vector<std::pair<const Resource*, double>> candidates;
+    CandidateTable table;
+    ExposureTracker exposure;
+    
+    // Exposures older than this have decayed below the floor, so the replay
+    // can start that long before the earliest entry
+    auto horizon = std::chrono::duration_cast<std::chrono::system_clock::duration>(
+        std::chrono::duration<double, std::ratio<3600>>(kExposureHalfLifeHours * std::log2(1.0 / kExposureFloor)));
+    auto replayFrom = entries[order.front()].timestamp - horizon;
+    size_t historyPos = std::partition_point(history.begin(), history.end(),
+                                             [&replayFrom](const MoodEntry& past) {
+                                                 return past.timestamp < replayFrom;
+                                             }) - history.begin();
+    
+    for (size_t index : order) {
+        const MoodEntry& entry = entries[index];
+        
+        // Replay what the user was shown for every earlier history entry
+        while (historyPos < history.size() && history[historyPos].timestamp < entry.timestamp) {
+            const MoodEntry& past = history[historyPos++];
+            exposure.advanceTo(past.timestamp);
+            if (!suggestsResources(past)) {
+                continue;
+            }
+            collectCandidates(past, candidates);
+            table.clear();
+            for (const auto& [resource, weight] : candidates) {
+                table.add(resource, weight);
+            }
+            for (const auto& shown : rankCandidates(table, exposure, kShownPerEntry)) {
+                exposure.record(*shown.resource);
+            }
+        }
+        exposure.advanceTo(entry.timestamp);
+        
+        // Accumulate and deduplicate this entry's candidates
+        collectCandidates(entry, candidates);
+        table.clear();
+        for (const auto& [resource, weight] : candidates) {
+            table.add(resource, weight);
+        }
+        
+        auto& ranked = results[index];
+        for (const auto& slot : rankCandidates(table, exposure, k)) {
+            ranked.push_back({*slot.resource, slot.score});
+        }
+    }
+    
+    return results;
+}
@@ -1,9 +1,12 @@
 #ifndef RESOURCE_MAP_H
 #define RESOURCE_MAP_H
 
+#include "MoodTracker.h"
 #include <map>
 #include <string>
 #include <vector>
+#include <cstddef>
+#include <utility>
 
 // Structure to store resource information
 struct Resource {
@@ -15,6 +18,12 @@ struct Resource {
     Resource(const std::string& title, const std::string& url, const std::string& description);
 };
 
+// Structure pairing a recommended resource with its ranking score
+struct RecommendedResource {
+    Resource resource;           // The recommended resource
+    double score;                // Ranking score (higher is more relevant)
+};
+
 class ResourceMap {
 private:
     // Map mood keywords to relevant resources
@@ -22,8 +31,15 @@ private:
     
     // Map mood score ranges to relevant resources
     std::map<int, std::vector<Resource>> scoreToResources;
+    
+    // Collect every resource relevant to an entry along with its base weight
+    void collectCandidates(const MoodEntry& entry,
+                           std::vector<std::pair<const Resource*, double>>& candidates) const;
 
 public:
+    // How many recommendations the app shows for one entry
+    static constexpr size_t kShownPerEntry = 3;
+    
     ResourceMap();
     
     // Initialize with default resources
@@ -46,6 +62,22 @@ public:
     
     // Get all available resources
     std::map<std::string, std::vector<Resource>> getAllMoodResources() const;
+    
+    // Whether the app suggests resources for an entry on its own: a low score
+    // or a clearly negative tone (alerts also trigger suggestions)
+    static bool suggestsResources(const MoodEntry& entry);
+    
+    // Recommend the top k resources for a mood entry, ranked by keyword hits,
+    // score proximity and how recently the user's history already surfaced them
+    std::vector<RecommendedResource> recommendResources(const MoodEntry& entry,
+                                                        const std::vector<MoodEntry>& history,
+                                                        size_t k) const;
+    
+    // Recommend the top k resources for each entry, scoring all of them in one pass
+    std::vector<std::vector<RecommendedResource>> recommendResourcesForEntries(
+        const std::vector<MoodEntry>& entries,
+        const std::vector<MoodEntry>& history,
+        size_t k) const;
 };
 
 #endif // RESOURCE_MAP_H
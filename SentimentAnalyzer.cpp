@@ -0,0 +1,377 @@
+#include "SentimentAnalyzer.h"
+#include "Tokenizer.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <cstdio>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+using json = nlohmann::json;
+
+namespace {
+
+const size_t kNegationScope = 3;        // Words after a negator that get flipped
+const double kNegationFactor = -0.75;   // "not happy" is negative, but less than "sad"
+const double kNormalizationAlpha = 15.0;
+const size_t kEntriesPerThread = 256;   // Below this, extra threads don't pay off
+const uint64_t kScoringVersion = 2;     // Bump when tokenizing or scoring changes, to drop cached scores
+
+// FNV-1a, stable across runs so hashes can be cached on disk
+uint64_t fnv1a(std::string_view text, uint64_t hash = 14695981039346656037ull) {
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Contribution of one lexicon word to the fingerprint
+uint64_t wordFingerprint(const std::string& word, float value, uint8_t kind) {
+    uint64_t hash = fnv1a(word);
+    hash = fnv1a(std::string_view(reinterpret_cast<const char*>(&value), sizeof(value)), hash);
+    return fnv1a(std::string_view(reinterpret_cast<const char*>(&kind), sizeof(kind)), hash);
+}
+
+// Hex form of a hash, used as a JSON key
+std::string toHex(uint64_t value) {
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(value));
+    return buffer;
+}
+
+} // namespace
+
+// SentimentAnalyzer constructor
+SentimentAnalyzer::SentimentAnalyzer() {
+    initializeDefaultLexicon();
+}
+
+// Empty the table and add the built-in negators and intensifiers
+void SentimentAnalyzer::resetLexicon() {
+    table.assign(256, Slot());
+    wordCount = 0;
+    fingerprint = 0;
+
+    for (const char* negator : {"not", "no", "never", "nothing", "without", "hardly", "barely",
+                                "don't", "dont", "doesn't", "doesnt", "didn't", "didnt",
+                                "isn't", "isnt", "wasn't", "wasnt", "aren't", "arent",
+                                "can't", "cant", "cannot", "won't", "wont", "nor"}) {
+        insertWord(negator, 0.0f, WordKind::Negator);
+    }
+
+    insertWord("very", 1.5f, WordKind::Modifier);
+    insertWord("really", 1.3f, WordKind::Modifier);
+    insertWord("so", 1.3f, WordKind::Modifier);
+    insertWord("extremely", 1.8f, WordKind::Modifier);
+    insertWord("super", 1.5f, WordKind::Modifier);
+    insertWord("incredibly", 1.7f, WordKind::Modifier);
+    insertWord("slightly", 0.6f, WordKind::Modifier);
+    insertWord("somewhat", 0.7f, WordKind::Modifier);
+    insertWord("kinda", 0.7f, WordKind::Modifier);
+    insertWord("little", 0.7f, WordKind::Modifier);
+}
+
+// Initialize with the default lexicon
+void SentimentAnalyzer::initializeDefaultLexicon() {
+    resetLexicon();
+
+    // Positive mood words
+    addWord("happy", 3.0f);
+    addWord("joyful", 3.0f);
+    addWord("cheerful", 3.0f);
+    addWord("great", 3.0f);
+    addWord("amazing", 3.0f);
+    addWord("wonderful", 3.0f);
+    addWord("love", 3.0f);
+    addWord("loved", 3.0f);
+    addWord("grateful", 3.0f);
+    addWord("excited", 3.0f);
+    addWord("good", 2.0f);
+    addWord("calm", 2.0f);
+    addWord("relaxed", 2.0f);
+    addWord("content", 2.0f);
+    addWord("hopeful", 2.0f);
+    addWord("peaceful", 2.0f);
+    addWord("energized", 2.0f);
+    addWord("motivated", 2.0f);
+    addWord("confident", 2.0f);
+    addWord("proud", 2.0f);
+    addWord("relieved", 2.0f);
+    addWord("better", 1.5f);
+    addWord("rested", 1.5f);
+    addWord("productive", 1.5f);
+    addWord("ok", 0.5f);
+    addWord("okay", 0.5f);
+    addWord("fine", 0.5f);
+
+    // Negative mood words
+    addWord("suicidal", -4.0f);
+    addWord("hopeless", -3.5f);
+    addWord("worthless", -3.5f);
+    addWord("depressed", -3.0f);
+    addWord("miserable", -3.0f);
+    addWord("awful", -3.0f);
+    addWord("terrible", -3.0f);
+    addWord("angry", -3.0f);
+    addWord("furious", -3.0f);
+    addWord("panic", -3.0f);
+    addWord("hate", -3.0f);
+    addWord("overwhelmed", -2.5f);
+    addWord("ashamed", -2.5f);
+    addWord("sad", -2.0f);
+    addWord("anxious", -2.0f);
+    addWord("worried", -2.0f);
+    addWord("stressed", -2.0f);
+    addWord("lonely", -2.0f);
+    addWord("scared", -2.0f);
+    addWord("afraid", -2.0f);
+    addWord("frustrated", -2.0f);
+    addWord("upset", -2.0f);
+    addWord("hurt", -2.0f);
+    addWord("bad", -2.0f);
+    addWord("exhausted", -2.0f);
+    addWord("empty", -2.0f);
+    addWord("guilty", -2.0f);
+    addWord("crying", -2.0f);
+    addWord("down", -1.5f);
+    addWord("numb", -1.5f);
+    addWord("nervous", -1.5f);
+    addWord("irritated", -1.5f);
+    addWord("restless", -1.5f);
+    addWord("sick", -1.5f);
+    addWord("tired", -1.0f);
+    addWord("bored", -1.0f);
+    addWord("confused", -1.0f);
+}
+
+// Load a lexicon from a JSON file, replacing the current one
+bool SentimentAnalyzer::loadLexiconFromFile(const std::string& filename) {
+    try {
+        // Open the file
+        std::ifstream inFile(filename);
+        if (!inFile.is_open()) {
+            return false;
+        }
+
+        // Parse JSON
+        json lexiconJson;
+        inFile >> lexiconJson;
+
+        // Build into a fresh analyzer so errors keep the current lexicon
+        SentimentAnalyzer loaded;
+        loaded.resetLexicon();
+        for (const auto& [word, valence] : lexiconJson.at("words").items()) {
+            loaded.addWord(word, valence.get<float>());
+        }
+
+        *this = std::move(loaded);
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+// Add a word with a valence (roughly -4 to +4)
+void SentimentAnalyzer::addWord(const std::string& word, float valence) {
+    // Case-fold, as descriptions are matched case-folded
+    insertWord(foldCase(word), valence, WordKind::Valence);
+}
+
+// Insert or replace a word, growing the table past half full
+void SentimentAnalyzer::insertWord(const std::string& word, float value, WordKind kind) {
+    if ((wordCount + 1) * 2 > table.size()) {
+        rehash(table.size() * 2);
+    }
+
+    size_t mask = table.size() - 1;
+    for (size_t i = fnv1a(word) & mask; ; i = (i + 1) & mask) {
+        Slot& slot = table[i];
+        if (slot.kind == WordKind::Empty) {
+            slot.word = word;
+            ++wordCount;
+        } else if (slot.word != word) {
+            continue;
+        } else {
+            fingerprint -= wordFingerprint(slot.word, slot.value, static_cast<uint8_t>(slot.kind));
+        }
+        slot.value = value;
+        slot.kind = kind;
+        fingerprint += wordFingerprint(word, value, static_cast<uint8_t>(kind));
+        return;
+    }
+}
+
+// Find a word's slot; nullptr if it's not in the lexicon
+const SentimentAnalyzer::Slot* SentimentAnalyzer::findWord(std::string_view word) const {
+    size_t mask = table.size() - 1;
+    for (size_t i = fnv1a(word) & mask; ; i = (i + 1) & mask) {
+        const Slot& slot = table[i];
+        if (slot.kind == WordKind::Empty) {
+            return nullptr;
+        }
+        if (slot.word == word) {
+            return &slot;
+        }
+    }
+}
+
+// Rebuild the table with a new capacity
+void SentimentAnalyzer::rehash(size_t capacity) {
+    std::vector<Slot> old(capacity);
+    old.swap(table);
+
+    size_t mask = table.size() - 1;
+    for (auto& slot : old) {
+        if (slot.kind == WordKind::Empty) {
+            continue;
+        }
+        size_t i = fnv1a(slot.word) & mask;
+        while (table[i].kind != WordKind::Empty) {
+            i = (i + 1) & mask;
+        }
+        table[i] = std::move(slot);
+    }
+}
+
+// Score a description from -1 (very negative) to +1 (very positive)
+double SentimentAnalyzer::scoreText(const std::string& text) const {
+    double total = 0.0;
+    size_t negatedWords = 0;        // Remaining words inside a negation
+    double modifier = 1.0;          // Pending intensifier for the next word
+
+    // One tokenizer per thread, so scoring reuses its buffers
+    static thread_local Tokenizer tokenizer;
+    tokenizer.tokenize(text);
+
+    for (size_t i = 0; i < tokenizer.wordCount(); ++i) {
+        const Slot* slot = findWord(tokenizer.word(i));
+        if (!slot) {
+            modifier = 1.0;
+            if (negatedWords > 0) --negatedWords;
+        } else if (slot->kind == WordKind::Negator) {
+            negatedWords = kNegationScope;
+        } else if (slot->kind == WordKind::Modifier) {
+            modifier *= slot->value;
+        } else {
+            double valence = slot->value * modifier;
+            if (negatedWords > 0) {
+                valence *= kNegationFactor;
+                negatedWords = 0;
+            }
+            total += valence;
+            modifier = 1.0;
+        }
+
+        // Punctuation ends any negation or pending intensifier
+        if (tokenizer.endsClause(i)) {
+            negatedWords = 0;
+            modifier = 1.0;
+        }
+    }
+
+    // Squash into [-1, 1]
+    return total / std::sqrt(total * total + kNormalizationAlpha);
+}
+
+// Score every entry, splitting the work across all cores
+void SentimentAnalyzer::scoreEntries(std::vector<MoodEntry>& entries) const {
+    size_t threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+    threadCount = std::min(threadCount, entries.size() / kEntriesPerThread + 1);
+
+    // Each thread takes an interleaved share so long and short entries balance out
+    auto work = [this, &entries, threadCount](size_t first) {
+        for (size_t i = first; i < entries.size(); i += threadCount) {
+            entries[i].sentiment = scoreText(entries[i].description);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < threadCount; ++t) {
+        threads.emplace_back(work, t);
+    }
+    work(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+// Score every entry, reusing and updating scores cached in cacheFile.
+// The cache maps description hashes to scores and is only trusted if it was
+// written with the same lexicon and scoring rules.
+bool SentimentAnalyzer::scoreEntriesCached(std::vector<MoodEntry>& entries,
+                                           const std::string& cacheFile) const {
+    std::string lexiconId = toHex(fingerprint + kScoringVersion);
+    std::unordered_map<std::string, double> cached;
+
+    // Read the existing cache, ignoring it if missing, corrupt or stale
+    try {
+        std::ifstream inFile(cacheFile);
+        if (inFile.is_open()) {
+            json cacheJson;
+            inFile >> cacheJson;
+            if (cacheJson.at("lexicon") == lexiconId) {
+                for (const auto& [key, value] : cacheJson.at("scores").items()) {
+                    cached[key] = value.get<double>();
+                }
+            }
+        }
+    } catch (...) {
+        cached.clear();
+    }
+
+    // Fill in cached scores and collect the rest
+    std::vector<std::string> keys(entries.size());
+    std::unordered_set<std::string> distinctKeys;
+    std::vector<MoodEntry> missing;
+    std::vector<size_t> missingIndex;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        keys[i] = toHex(fnv1a(entries[i].description));
+        distinctKeys.insert(keys[i]);
+        auto it = cached.find(keys[i]);
+        if (it != cached.end()) {
+            entries[i].sentiment = it->second;
+        } else {
+            missing.push_back(entries[i]);
+            missingIndex.push_back(i);
+        }
+    }
+
+    // Nothing to add or drop: repeated descriptions share one cache key
+    if (missing.empty() && cached.size() == distinctKeys.size()) {
+        return true;
+    }
+
+    scoreEntries(missing);
+    for (size_t i = 0; i < missing.size(); ++i) {
+        entries[missingIndex[i]].sentiment = missing[i].sentiment;
+    }
+
+    // Rewrite the cache with exactly the current descriptions
+    try {
+        json scoresJson = json::object();
+        for (size_t i = 0; i < entries.size(); ++i) {
+            scoresJson[keys[i]] = entries[i].sentiment;
+        }
+        json cacheJson = {
+            {"lexicon", lexiconId},
+            {"scores", scoresJson}
+        };
+
+        std::ofstream outFile(cacheFile);
+        if (!outFile.is_open()) {
+            return false;
+        }
+        outFile << cacheJson << std::endl;
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+// Identifies the current lexicon contents
+uint64_t SentimentAnalyzer::getFingerprint() const {
+    return fingerprint;
+}
@@ -0,0 +1,70 @@
+#ifndef SENTIMENT_ANALYZER_H
+#define SENTIMENT_ANALYZER_H
+
+#include "MoodTracker.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Scores free-text mood descriptions with a word lexicon.
+//
+// Each lexicon word carries a valence (roughly -4 to +4). Negators such as
+// "not" flip the valence of the next few words, and intensifiers such as
+// "very" scale the next one. The summed valence is squashed into [-1, 1].
+// The lexicon lives in a flat open-addressing hash table so scoring a
+// description costs one probe per word and no allocations.
+class SentimentAnalyzer {
+private:
+    // What a lexicon word does to the score
+    enum class WordKind : uint8_t { Empty, Valence, Negator, Modifier };
+
+    // One slot of the open-addressing table
+    struct Slot {
+        std::string word;
+        float value = 0.0f;                 // Valence, or multiplier for modifiers
+        WordKind kind = WordKind::Empty;
+    };
+
+    std::vector<Slot> table;                // Capacity is a power of two
+    size_t wordCount = 0;
+    uint64_t fingerprint = 0;               // Changes whenever the lexicon does
+
+    // Insert or replace a word, growing the table past half full
+    void insertWord(const std::string& word, float value, WordKind kind);
+
+    // Find a word's slot; nullptr if it's not in the lexicon
+    const Slot* findWord(std::string_view word) const;
+
+    // Rebuild the table with a new capacity
+    void rehash(size_t capacity);
+
+    // Empty the table and add the built-in negators and intensifiers
+    void resetLexicon();
+
+public:
+    SentimentAnalyzer();
+
+    // Initialize with the default lexicon
+    void initializeDefaultLexicon();
+
+    // Load a lexicon from a JSON file, replacing the current one
+    bool loadLexiconFromFile(const std::string& filename);
+
+    // Add a word with a valence (roughly -4 to +4)
+    void addWord(const std::string& word, float valence);
+
+    // Score a description from -1 (very negative) to +1 (very positive)
+    double scoreText(const std::string& text) const;
+
+    // Score every entry, splitting the work across all cores
+    void scoreEntries(std::vector<MoodEntry>& entries) const;
+
+    // Score every entry, reusing and updating scores cached in cacheFile
+    bool scoreEntriesCached(std::vector<MoodEntry>& entries, const std::string& cacheFile) const;
+
+    // Identifies the current lexicon contents
+    uint64_t getFingerprint() const;
+};
+
+#endif // SENTIMENT_ANALYZER_H
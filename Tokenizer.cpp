@@ -0,0 +1,514 @@
+#include "Tokenizer.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iterator>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TOKENIZER_SSE2 1
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace {
+
+// What a character does to the word around it
+enum class CharClass : uint8_t {
+    Word,           // Part of a word
+    Apostrophe,     // Part of a word, folded to '\''
+    Separator,      // Ends a word
+    ClauseEnd       // Ends a word and the clause it's in
+};
+
+// ASCII byte properties
+const uint8_t kWordByte = 1;
+const uint8_t kUpperByte = 2;
+const uint8_t kClauseByte = 4;
+
+constexpr std::array<uint8_t, 128> makeAsciiTable() {
+    std::array<uint8_t, 128> table{};
+    for (int c = 'a'; c <= 'z'; ++c) table[c] = kWordByte;
+    for (int c = 'A'; c <= 'Z'; ++c) table[c] = kWordByte | kUpperByte;
+    for (int c = '0'; c <= '9'; ++c) table[c] = kWordByte;
+    table['\''] = kWordByte;
+    for (char c : {'.', ',', ';', ':', '!', '?'}) table[static_cast<unsigned char>(c)] = kClauseByte;
+    return table;
+}
+
+const std::array<uint8_t, 128> kAsciiTable = makeAsciiTable();
+
+// How to decode a sequence from its lead byte: total length (0 if the byte
+// can't start one) and the valid range of the second byte, which rules out
+// overlong forms, surrogates and code points past U+10FFFF
+struct Utf8Lead {
+    uint8_t length;
+    uint8_t secondMin;
+    uint8_t secondMax;
+};
+
+constexpr std::array<Utf8Lead, 256> makeUtf8Table() {
+    std::array<Utf8Lead, 256> table{};
+    for (int b = 0xC2; b <= 0xDF; ++b) table[b] = {2, 0x80, 0xBF};
+    for (int b = 0xE0; b <= 0xEF; ++b) table[b] = {3, 0x80, 0xBF};
+    table[0xE0] = {3, 0xA0, 0xBF};
+    table[0xED] = {3, 0x80, 0x9F};
+    for (int b = 0xF0; b <= 0xF4; ++b) table[b] = {4, 0x80, 0xBF};
+    table[0xF0] = {4, 0x90, 0xBF};
+    table[0xF4] = {4, 0x80, 0x8F};
+    return table;
+}
+
+const std::array<Utf8Lead, 256> kUtf8Table = makeUtf8Table();
+
+// Non-ASCII code points that aren't word characters, sorted. Everything not
+// listed is treated as part of a word.
+struct ClassRange {
+    char32_t first;
+    char32_t last;
+    CharClass charClass;
+};
+
+const ClassRange kClassRanges[] = {
+    {0x0080, 0x00A9, CharClass::Separator},     // C1 controls, no-break space, ¡ © ...
+    {0x00AB, 0x00B4, CharClass::Separator},     // « ¬ ® ° ± ...
+    {0x00B6, 0x00B9, CharClass::Separator},     // ¶ · ...
+    {0x00BB, 0x00BF, CharClass::Separator},     // » ¼ ½ ¾ ¿
+    {0x00D7, 0x00D7, CharClass::Separator},     // ×
+    {0x00F7, 0x00F7, CharClass::Separator},     // ÷
+    {0x037E, 0x037E, CharClass::ClauseEnd},     // Greek question mark
+    {0x0387, 0x0387, CharClass::ClauseEnd},     // Greek ano teleia
+    {0x055A, 0x055F, CharClass::Separator},     // Armenian punctuation
+    {0x0589, 0x0589, CharClass::ClauseEnd},     // Armenian full stop
+    {0x05BE, 0x05BE, CharClass::Separator},     // Hebrew punctuation
+    {0x05C0, 0x05C0, CharClass::Separator},
+    {0x05C3, 0x05C3, CharClass::ClauseEnd},
+    {0x05C6, 0x05C6, CharClass::Separator},
+    {0x05F3, 0x05F4, CharClass::Separator},
+    {0x0600, 0x060B, CharClass::Separator},     // Arabic signs and punctuation
+    {0x060C, 0x060C, CharClass::ClauseEnd},
+    {0x060D, 0x060F, CharClass::Separator},
+    {0x061B, 0x061B, CharClass::ClauseEnd},
+    {0x061D, 0x061E, CharClass::Separator},
+    {0x061F, 0x061F, CharClass::ClauseEnd},
+    {0x066A, 0x066D, CharClass::Separator},
+    {0x06D4, 0x06D4, CharClass::ClauseEnd},
+    {0x0964, 0x0965, CharClass::ClauseEnd},     // Devanagari danda
+    {0x0E4F, 0x0E4F, CharClass::Separator},     // Thai punctuation
+    {0x0E5A, 0x0E5B, CharClass::ClauseEnd},
+    {0x1680, 0x1680, CharClass::Separator},     // Ogham space
+    {0x2000, 0x200B, CharClass::Separator},     // Spaces (joiners 200C-200D stay in words)
+    {0x200E, 0x2018, CharClass::Separator},     // Marks, dashes, opening quote
+    {0x2019, 0x2019, CharClass::Apostrophe},    // Right single quote, used as an apostrophe
+    {0x201A, 0x2025, CharClass::Separator},
+    {0x2026, 0x2026, CharClass::ClauseEnd},     // …
+    {0x2027, 0x203B, CharClass::Separator},
+    {0x203C, 0x203D, CharClass::ClauseEnd},     // ‼ ‽
+    {0x203E, 0x2046, CharClass::Separator},
+    {0x2047, 0x2049, CharClass::ClauseEnd},     // ⁇ ⁈ ⁉
+    {0x204A, 0x206F, CharClass::Separator},
+    {0x20A0, 0x20CF, CharClass::Separator},     // Currency symbols
+    {0x2100, 0x2BFF, CharClass::Separator},     // Letterlike symbols through miscellaneous symbols
+    {0x2E00, 0x2E7F, CharClass::Separator},     // Supplemental punctuation
+    {0x3000, 0x3000, CharClass::Separator},     // Ideographic space
+    {0x3001, 0x3002, CharClass::ClauseEnd},     // 、 。
+    {0x3003, 0x3004, CharClass::Separator},
+    {0x3008, 0x3020, CharClass::Separator},     // CJK brackets and marks
+    {0x3030, 0x3030, CharClass::Separator},
+    {0x303D, 0x303D, CharClass::Separator},
+    {0xE000, 0xF8FF, CharClass::Separator},     // Private use
+    {0xFE00, 0xFE1F, CharClass::Separator},     // Variation selectors, vertical forms
+    {0xFE30, 0xFE4F, CharClass::Separator},     // CJK compatibility forms
+    {0xFE50, 0xFE57, CharClass::ClauseEnd},     // Small , . ; : ? !
+    {0xFE58, 0xFE6F, CharClass::Separator},
+    {0xFEFF, 0xFEFF, CharClass::Separator},     // Byte order mark
+    {0xFF01, 0xFF01, CharClass::ClauseEnd},     // Fullwidth punctuation
+    {0xFF02, 0xFF0B, CharClass::Separator},
+    {0xFF0C, 0xFF0C, CharClass::ClauseEnd},
+    {0xFF0D, 0xFF0D, CharClass::Separator},
+    {0xFF0E, 0xFF0E, CharClass::ClauseEnd},
+    {0xFF0F, 0xFF0F, CharClass::Separator},
+    {0xFF1A, 0xFF1B, CharClass::ClauseEnd},
+    {0xFF1C, 0xFF1E, CharClass::Separator},
+    {0xFF1F, 0xFF1F, CharClass::ClauseEnd},
+    {0xFF20, 0xFF20, CharClass::Separator},
+    {0xFF3B, 0xFF40, CharClass::Separator},
+    {0xFF5B, 0xFF60, CharClass::Separator},
+    {0xFF61, 0xFF61, CharClass::ClauseEnd},     // Halfwidth 。
+    {0xFF62, 0xFF63, CharClass::Separator},
+    {0xFF64, 0xFF64, CharClass::ClauseEnd},     // Halfwidth 、
+    {0xFF65, 0xFF65, CharClass::Separator},
+    {0xFFF0, 0xFFFF, CharClass::Separator},     // Specials
+    {0x1F000, 0x1FAFF, CharClass::Separator},   // Emoji, pictographs and other symbols
+    {0xE0000, 0xE007F, CharClass::Separator},   // Tags
+    {0xF0000, 0x10FFFF, CharClass::Separator}   // Private use planes
+};
+
+// Case folding for a range: every code point moves by delta, or with
+// alternating set, only those at even offsets from first (upper/lower pairs)
+struct FoldRange {
+    char32_t first;
+    char32_t last;
+    int32_t delta;
+    bool alternating;
+};
+
+const FoldRange kFoldRanges[] = {
+    {0x00B5, 0x00B5, 775, false},       // µ -> μ
+    {0x00C0, 0x00D6, 32, false},        // Latin-1
+    {0x00D8, 0x00DE, 32, false},
+    {0x0100, 0x012F, 1, true},          // Latin Extended-A
+    {0x0130, 0x0130, -199, false},      // İ -> i
+    {0x0132, 0x0137, 1, true},
+    {0x0139, 0x0148, 1, true},
+    {0x014A, 0x0177, 1, true},
+    {0x0178, 0x0178, -121, false},      // Ÿ -> ÿ
+    {0x0179, 0x017E, 1, true},
+    {0x017F, 0x017F, -268, false},      // ſ -> s
+    {0x01CD, 0x01DC, 1, true},          // Latin Extended-B (regular parts)
+    {0x01DE, 0x01EF, 1, true},
+    {0x01F8, 0x021F, 1, true},
+    {0x0222, 0x0233, 1, true},
+    {0x0386, 0x0386, 38, false},        // Greek
+    {0x0388, 0x038A, 37, false},
+    {0x038C, 0x038C, 64, false},
+    {0x038E, 0x038F, 63, false},
+    {0x0391, 0x03A1, 32, false},
+    {0x03A3, 0x03AB, 32, false},
+    {0x03C2, 0x03C2, 1, false},         // Final sigma
+    {0x03D8, 0x03EF, 1, true},
+    {0x0400, 0x040F, 80, false},        // Cyrillic
+    {0x0410, 0x042F, 32, false},
+    {0x0460, 0x0481, 1, true},
+    {0x048A, 0x04BF, 1, true},
+    {0x04C0, 0x04C0, 15, false},
+    {0x04C1, 0x04CE, 1, true},
+    {0x04D0, 0x052F, 1, true},
+    {0x0531, 0x0556, 48, false},        // Armenian
+    {0x10A0, 0x10C5, 7264, false},      // Georgian
+    {0x1E00, 0x1E95, 1, true},          // Latin Extended Additional
+    {0x1EA0, 0x1EFF, 1, true},
+    {0x1F08, 0x1F0F, -8, false},        // Greek Extended (regular parts)
+    {0x1F18, 0x1F1D, -8, false},
+    {0x1F28, 0x1F2F, -8, false},
+    {0x1F38, 0x1F3F, -8, false},
+    {0x1F48, 0x1F4D, -8, false},
+    {0x1F68, 0x1F6F, -8, false},
+    {0xFF21, 0xFF3A, 32, false}         // Fullwidth Latin
+};
+
+// The range in a sorted table that contains a code point, or nullptr
+template <typename Range, size_t N>
+const Range* findRange(const Range (&ranges)[N], char32_t codePoint) {
+    auto after = std::upper_bound(std::begin(ranges), std::end(ranges), codePoint,
+                                  [](char32_t value, const Range& range) { return value < range.first; });
+    if (after == std::begin(ranges) || std::prev(after)->last < codePoint) {
+        return nullptr;
+    }
+    return &*std::prev(after);
+}
+
+// Class of a non-ASCII code point
+CharClass classify(char32_t codePoint) {
+    const ClassRange* range = findRange(kClassRanges, codePoint);
+    return range ? range->charClass : CharClass::Word;
+}
+
+// Decode the sequence at text[index]; returns its length, or 0 if it's invalid
+size_t decodeUtf8(std::string_view text, size_t index, char32_t& codePoint) {
+    unsigned char lead = static_cast<unsigned char>(text[index]);
+    const Utf8Lead& info = kUtf8Table[lead];
+    if (info.length == 0 || text.size() - index < info.length) {
+        return 0;
+    }
+
+    unsigned char second = static_cast<unsigned char>(text[index + 1]);
+    if (second < info.secondMin || second > info.secondMax) {
+        return 0;
+    }
+    codePoint = lead & (0x7F >> info.length);
+    codePoint = (codePoint << 6) | (second & 0x3F);
+    for (size_t i = 2; i < info.length; ++i) {
+        unsigned char next = static_cast<unsigned char>(text[index + i]);
+        if ((next & 0xC0) != 0x80) {
+            return 0;
+        }
+        codePoint = (codePoint << 6) | (next & 0x3F);
+    }
+    return info.length;
+}
+
+// Append a code point as UTF-8
+void appendUtf8(std::string& out, char32_t codePoint) {
+    if (codePoint < 0x80) {
+        out.push_back(static_cast<char>(codePoint));
+    } else if (codePoint < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+        out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    } else if (codePoint < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+// Append the case-folded form of a non-ASCII code point
+void appendFolded(std::string& out, char32_t codePoint) {
+    // ß and ẞ fold to two letters
+    if (codePoint == 0x00DF || codePoint == 0x1E9E) {
+        out += "ss";
+        return;
+    }
+    const FoldRange* range = findRange(kFoldRanges, codePoint);
+    if (range && (!range->alternating || (codePoint - range->first) % 2 == 0)) {
+        codePoint = static_cast<char32_t>(static_cast<int32_t>(codePoint) + range->delta);
+    }
+    appendUtf8(out, codePoint);
+}
+
+// Lowercase an ASCII byte
+char lowerAscii(unsigned char c) {
+    return static_cast<char>(kAsciiTable[c] & kUpperByte ? c | 0x20 : c);
+}
+
+// Index of the lowest set bit (bits must not be 0)
+unsigned lowestBit(unsigned bits) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_ctz(bits));
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, bits);
+    return static_cast<unsigned>(index);
+#else
+    unsigned index = 0;
+    while (!(bits & 1u)) {
+        bits >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+const size_t kBlockSize = 16;
+
+} // namespace
+
+// Split text into words, replacing the previous result
+void Tokenizer::tokenize(std::string_view text) {
+    folded.clear();
+    spans.clear();
+    inWord = false;
+    folded.reserve(text.size());
+
+    size_t index = 0;
+    while (index < text.size()) {
+#ifdef TOKENIZER_SSE2
+        if (text.size() - index >= kBlockSize) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + index));
+            if (_mm_movemask_epi8(bytes) == 0) {
+                // All ASCII, so signed comparisons work as unsigned ones
+                auto inRange = [&bytes](char low, char high) {
+                    return _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8(low - 1)),
+                                         _mm_cmplt_epi8(bytes, _mm_set1_epi8(high + 1)));
+                };
+                auto equals = [&bytes](char c) { return _mm_cmpeq_epi8(bytes, _mm_set1_epi8(c)); };
+
+                __m128i upper = inRange('A', 'Z');
+                __m128i word = _mm_or_si128(_mm_or_si128(upper, inRange('a', 'z')),
+                                            _mm_or_si128(inRange('0', '9'), equals('\'')));
+                __m128i clause = _mm_or_si128(_mm_or_si128(_mm_or_si128(equals('.'), equals(',')),
+                                                           _mm_or_si128(equals(';'), equals(':'))),
+                                              _mm_or_si128(equals('!'), equals('?')));
+
+                alignas(16) char lowered[kBlockSize];
+                _mm_store_si128(reinterpret_cast<__m128i*>(lowered),
+                                _mm_or_si128(bytes, _mm_and_si128(upper, _mm_set1_epi8(0x20))));
+                addAsciiBlock(lowered, static_cast<unsigned>(_mm_movemask_epi8(word)),
+                              static_cast<unsigned>(_mm_movemask_epi8(clause)), kBlockSize);
+                index += kBlockSize;
+                continue;
+            }
+
+            // Mixed block: decode it character by character
+            size_t blockEnd = index + kBlockSize;
+            while (index < blockEnd) {
+                index = addCharacter(text, index);
+            }
+            continue;
+        }
+#endif
+        index = addCharacter(text, index);
+    }
+
+    if (inWord) {
+        endWord();
+    }
+}
+
+// Consume a block of ASCII bytes. Word bytes are copied a run at a time;
+// the gaps between runs only matter for whether they end a clause.
+void Tokenizer::addAsciiBlock(const char* lowered, unsigned wordBits, unsigned clauseBits, size_t length) {
+    unsigned blockBits = (1u << length) - 1;
+    size_t position = 0;
+    while (position < length) {
+        if (inWord) {
+            unsigned rest = (~wordBits & blockBits) >> position;
+            size_t run = rest ? lowestBit(rest) : length - position;
+            folded.append(lowered + position, run);
+            position += run;
+            if (position < length) {
+                endWord();
+            }
+        } else {
+            unsigned rest = wordBits >> position;
+            size_t gap = rest ? lowestBit(rest) : length - position;
+            if (clauseBits & (((1u << gap) - 1) << position)) {
+                endClause();
+            }
+            position += gap;
+            if (position < length) {
+                startWord();
+            }
+        }
+    }
+}
+
+// Consume the character at text[index]; returns the index after it
+size_t Tokenizer::addCharacter(std::string_view text, size_t index) {
+    unsigned char c = static_cast<unsigned char>(text[index]);
+    if (c < 0x80) {
+        uint8_t properties = kAsciiTable[c];
+        if (properties & kWordByte) {
+            startWord();
+            folded.push_back(lowerAscii(c));
+        } else {
+            endWord();
+            if (properties & kClauseByte) {
+                endClause();
+            }
+        }
+        return index + 1;
+    }
+
+    char32_t codePoint = 0;
+    size_t length = decodeUtf8(text, index, codePoint);
+    if (length == 0) {
+        // Skip a byte that doesn't start a valid sequence
+        endWord();
+        return index + 1;
+    }
+
+    switch (classify(codePoint)) {
+        case CharClass::Word:
+            startWord();
+            appendFolded(folded, codePoint);
+            break;
+        case CharClass::Apostrophe:
+            startWord();
+            folded.push_back('\'');
+            break;
+        case CharClass::Separator:
+            endWord();
+            break;
+        case CharClass::ClauseEnd:
+            endWord();
+            endClause();
+            break;
+    }
+    return index + length;
+}
+
+// Begin a word unless one is already open
+void Tokenizer::startWord() {
+    if (!inWord) {
+        inWord = true;
+        wordStart = folded.size();
+    }
+}
+
+// Close the open word, trimming apostrophes used as quotes around it
+void Tokenizer::endWord() {
+    if (!inWord) {
+        return;
+    }
+    inWord = false;
+
+    size_t begin = wordStart;
+    size_t end = folded.size();
+    while (begin < end && folded[begin] == '\'') ++begin;
+    while (end > begin && folded[end - 1] == '\'') --end;
+    if (begin == end) {
+        folded.resize(wordStart);
+        return;
+    }
+    spans.push_back({begin, end - begin, false});
+}
+
+// Mark the last word as ending a clause
+void Tokenizer::endClause() {
+    if (!spans.empty()) {
+        spans.back().endsClause = true;
+    }
+}
+
+// Number of words found
+size_t Tokenizer::wordCount() const {
+    return spans.size();
+}
+
+// A word, valid until the next call to tokenize
+std::string_view Tokenizer::word(size_t index) const {
+    return std::string_view(folded).substr(spans[index].offset, spans[index].length);
+}
+
+// Whether clause or sentence punctuation follows a word
+bool Tokenizer::endsClause(size_t index) const {
+    return spans[index].endsClause;
+}
+
+// Split text into case-folded words
+std::vector<std::string> extractWords(std::string_view text) {
+    Tokenizer tokenizer;
+    tokenizer.tokenize(text);
+
+    std::vector<std::string> words;
+    words.reserve(tokenizer.wordCount());
+    for (size_t i = 0; i < tokenizer.wordCount(); ++i) {
+        words.emplace_back(tokenizer.word(i));
+    }
+    return words;
+}
+
+// Case-fold text without splitting it; invalid UTF-8 is copied unchanged
+std::string foldCase(std::string_view text) {
+    std::string result;
+    result.reserve(text.size());
+
+    size_t index = 0;
+    while (index < text.size()) {
+        unsigned char c = static_cast<unsigned char>(text[index]);
+        if (c < 0x80) {
+            result.push_back(lowerAscii(c));
+            ++index;
+            continue;
+        }
+
+        char32_t codePoint = 0;
+        size_t length = decodeUtf8(text, index, codePoint);
+        if (length == 0) {
+            result.push_back(static_cast<char>(c));
+            ++index;
+        } else {
+            appendFolded(result, codePoint);
+            index += length;
+        }
+    }
+    return result;
+}
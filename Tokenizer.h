@@ -0,0 +1,68 @@
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Splits UTF-8 text into case-folded words.
+//
+// A word is a run of letters, digits, combining marks and inner apostrophes
+// (' or U+2019); everything else, including non-ASCII punctuation, spaces and
+// symbols such as emoji, separates words. Invalid UTF-8 is treated as a
+// separator. Letters are case-folded for Latin, Greek, Cyrillic, Armenian and
+// Georgian scripts and for fullwidth forms ("ß" and "ẞ" fold to "ss"); text is
+// not otherwise normalized.
+//
+// All-ASCII stretches are classified 16 bytes at a time with SSE2 where it's
+// available; other bytes go through table-driven UTF-8 decoding. A Tokenizer
+// reuses its buffers, so tokenizing many texts with one instance allocates
+// only when a text is larger than any before it.
+class Tokenizer {
+private:
+    // A word's place in the folded buffer
+    struct Span {
+        size_t offset;
+        size_t length;
+        bool endsClause;
+    };
+
+    std::string folded;             // Folded words, back to back
+    std::vector<Span> spans;
+    size_t wordStart = 0;           // Offset of the word being built
+    bool inWord = false;
+
+    // Consume a block of ASCII bytes given its lowercased bytes and
+    // bitmasks of word bytes and clause-ending bytes
+    void addAsciiBlock(const char* lowered, unsigned wordBits, unsigned clauseBits, size_t length);
+
+    // Consume the character at text[index]; returns the index after it
+    size_t addCharacter(std::string_view text, size_t index);
+
+    // Word boundaries
+    void startWord();
+    void endWord();
+    void endClause();
+
+public:
+    // Split text into words, replacing the previous result
+    void tokenize(std::string_view text);
+
+    // Number of words found
+    size_t wordCount() const;
+
+    // A word, valid until the next call to tokenize
+    std::string_view word(size_t index) const;
+
+    // Whether clause or sentence punctuation (. , ; : ! ? and their
+    // non-ASCII counterparts) follows a word
+    bool endsClause(size_t index) const;
+};
+
+// Split text into case-folded words
+std::vector<std::string> extractWords(std::string_view text);
+
+// Case-fold text without splitting it, e.g. a lexicon word or mood keyword
+std::string foldCase(std::string_view text);
+
+#endif // TOKENIZER_H
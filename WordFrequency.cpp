@@ -0,0 +1,245 @@
+#include "WordFrequency.h"
+#include "LocalDate.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+// Rows per sketch; each row is an independent guess at a word's count
+const size_t kSketchDepth = 4;
+const size_t kMaxSketchDepth = 8;
+
+// Overall summary: 64 KB of counters and 200 candidate words
+const size_t kOverallWidth = 4096;
+const size_t kOverallCapacity = 200;
+
+// Per-month summaries: 16 KB of counters and 50 candidate words each
+const size_t kMonthWidth = 1024;
+const size_t kMonthCapacity = 50;
+const size_t kMonthsKept = 12;
+
+// FNV-1a over the word's bytes
+uint64_t fnv1a(std::string_view text) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Most frequent first; leaves ties to the caller
+bool moreFrequent(const std::pair<std::string, int>& a, const std::pair<std::string, int>& b) {
+    return a.second > b.second;
+}
+
+} // namespace
+
+// Width is rounded up to a power of two; depth is capped at 8
+CountMinSketch::CountMinSketch(size_t width, size_t depth)
+    : width(1), depth(std::clamp<size_t>(depth, 1, kMaxSketchDepth)) {
+    while (this->width < width) {
+        this->width *= 2;
+    }
+    counters.assign(this->width * this->depth, 0);
+}
+
+// Counter index of a word in each row. The rows' hashes are derived from two
+// halves of one 64-bit hash (h1 + i * h2), which is as good as independent
+// hash functions for this purpose.
+void CountMinSketch::locate(std::string_view word, size_t* slots) const {
+    uint64_t hash = fnv1a(word);
+    uint32_t h1 = static_cast<uint32_t>(hash);
+    uint32_t h2 = static_cast<uint32_t>(hash >> 32) | 1;
+    for (size_t row = 0; row < depth; ++row) {
+        slots[row] = row * width + ((h1 + row * h2) & (width - 1));
+    }
+}
+
+// Count a word
+void CountMinSketch::add(std::string_view word, uint32_t count) {
+    size_t slots[kMaxSketchDepth];
+    locate(word, slots);
+
+    uint32_t current = std::numeric_limits<uint32_t>::max();
+    for (size_t row = 0; row < depth; ++row) {
+        current = std::min(current, counters[slots[row]]);
+    }
+    uint32_t target = current + std::min(count, std::numeric_limits<uint32_t>::max() - current);
+    for (size_t row = 0; row < depth; ++row) {
+        counters[slots[row]] = std::max(counters[slots[row]], target);
+    }
+}
+
+// Upper bound on how often a word was counted
+uint32_t CountMinSketch::estimate(std::string_view word) const {
+    size_t slots[kMaxSketchDepth];
+    locate(word, slots);
+
+    uint32_t result = std::numeric_limits<uint32_t>::max();
+    for (size_t row = 0; row < depth; ++row) {
+        result = std::min(result, counters[slots[row]]);
+    }
+    return result;
+}
+
+// Forget every count
+void CountMinSketch::clear() {
+    std::fill(counters.begin(), counters.end(), 0);
+}
+
+SpaceSaving::SpaceSaving(size_t capacity) : capacity(std::max<size_t>(capacity, 1)) {
+    heap.reserve(this->capacity);
+}
+
+// Restore heap order after a counter at index grew
+void SpaceSaving::siftDown(size_t index) {
+    while (true) {
+        size_t smallest = index;
+        for (size_t child = 2 * index + 1; child <= 2 * index + 2 && child < heap.size(); ++child) {
+            if (heap[child].count < heap[smallest].count) {
+                smallest = child;
+            }
+        }
+        if (smallest == index) {
+            return;
+        }
+        std::swap(heap[index], heap[smallest]);
+        positions[heap[index].word] = index;
+        positions[heap[smallest].word] = smallest;
+        index = smallest;
+    }
+}
+
+// Count a word
+void SpaceSaving::add(const std::string& word, uint32_t count) {
+    auto found = positions.find(word);
+    if (found != positions.end()) {
+        heap[found->second].count += count;
+        siftDown(found->second);
+        return;
+    }
+
+    if (heap.size() < capacity) {
+        // A free counter; sift it up to its place
+        heap.push_back({word, count, 0});
+        size_t index = heap.size() - 1;
+        positions[word] = index;
+        while (index > 0 && heap[(index - 1) / 2].count > heap[index].count) {
+            size_t parent = (index - 1) / 2;
+            std::swap(heap[index], heap[parent]);
+            positions[heap[index].word] = index;
+            positions[heap[parent].word] = parent;
+            index = parent;
+        }
+        return;
+    }
+
+    // Take over the least frequent word's counter
+    Counter& evicted = heap.front();
+    positions.erase(evicted.word);
+    evicted.error = evicted.count;
+    evicted.count += count;
+    evicted.word = word;
+    positions[word] = 0;
+    siftDown(0);
+}
+
+// Monitored words with their counts, most frequent first; ties go to
+// the word with the larger guaranteed count
+std::vector<std::pair<std::string, int>> SpaceSaving::top(size_t count) const {
+    std::vector<const Counter*> ranked;
+    ranked.reserve(heap.size());
+    for (const auto& counter : heap) {
+        ranked.push_back(&counter);
+    }
+    std::sort(ranked.begin(), ranked.end(), [](const Counter* a, const Counter* b) {
+        if (a->count != b->count) return a->count > b->count;
+        if (a->count - a->error != b->count - b->error) return a->count - a->error > b->count - b->error;
+        return a->word < b->word;
+    });
+    if (ranked.size() > count) {
+        ranked.resize(count);
+    }
+
+    std::vector<std::pair<std::string, int>> words;
+    words.reserve(ranked.size());
+    for (const Counter* counter : ranked) {
+        words.emplace_back(counter->word, static_cast<int>(counter->count));
+    }
+    return words;
+}
+
+// Forget every count
+void SpaceSaving::clear() {
+    heap.clear();
+    positions.clear();
+}
+
+WordFrequencyTracker::Summary::Summary(size_t width, size_t capacity)
+    : sketch(width, kSketchDepth), heavyHitters(capacity) {}
+
+void WordFrequencyTracker::Summary::add(const std::string& word, uint32_t count) {
+    sketch.add(word, count);
+    heavyHitters.add(word, count);
+}
+
+// Both structures only ever overcount, so the smaller count is the better one.
+// The sort is stable so that equal counts keep heavyHitters' ranking.
+std::vector<std::pair<std::string, int>> WordFrequencyTracker::Summary::top(size_t count) const {
+    auto words = heavyHitters.top(std::numeric_limits<size_t>::max());
+    for (auto& [word, wordCount] : words) {
+        wordCount = std::min(wordCount, static_cast<int>(sketch.estimate(word)));
+    }
+    std::stable_sort(words.begin(), words.end(), moreFrequent);
+    if (words.size() > count) {
+        words.erase(words.begin() + count, words.end());
+    }
+    return words;
+}
+
+WordFrequencyTracker::WordFrequencyTracker() : overall(kOverallWidth, kOverallCapacity) {}
+
+// Count a word used on a local day
+void WordFrequencyTracker::addWord(const std::string& word, long long day, int count) {
+    if (count <= 0) {
+        return;
+    }
+    overall.add(word, static_cast<uint32_t>(count));
+
+    // Start a summary for a new month, dropping the oldest one when full
+    long long month = startOfMonth(day);
+    auto found = months.find(month);
+    if (found == months.end()) {
+        if (months.size() >= kMonthsKept && month < months.begin()->first) {
+            return;
+        }
+        found = months.try_emplace(month, kMonthWidth, kMonthCapacity).first;
+        if (months.size() > kMonthsKept) {
+            months.erase(months.begin());
+        }
+    }
+    found->second.add(word, static_cast<uint32_t>(count));
+}
+
+// Most frequent words ever, most frequent first, with estimated counts
+std::vector<std::pair<std::string, int>> WordFrequencyTracker::getTopWords(size_t count) const {
+    return overall.top(count);
+}
+
+// Most frequent words in the month containing a day
+std::vector<std::pair<std::string, int>> WordFrequencyTracker::getTopWordsForMonth(long long day,
+                                                                                 size_t count) const {
+    auto found = months.find(startOfMonth(day));
+    if (found == months.end()) {
+        return {};
+    }
+    return found->second.top(count);
+}
+
+// Forget every count
+void WordFrequencyTracker::clear() {
+    overall.sketch.clear();
+    overall.heavyHitters.clear();
+    months.clear();
+}
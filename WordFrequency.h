@@ -0,0 +1,118 @@
+#ifndef WORD_FREQUENCY_H
+#define WORD_FREQUENCY_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Approximate counts for an unbounded set of words in a fixed-size table.
+//
+// Each word increments one counter in each of `depth` rows; its estimate is
+// the smallest of those counters, which never undercounts. Increments are
+// conservative (only counters that equal the current estimate grow), which
+// keeps collisions from inflating other words' counts as quickly.
+class CountMinSketch {
+private:
+    size_t width;                       // Counters per row, a power of two
+    size_t depth;                       // Number of rows
+    std::vector<uint32_t> counters;     // depth rows of width counters
+
+    // Counter index of a word in each row
+    void locate(std::string_view word, size_t* slots) const;
+
+public:
+    // Width is rounded up to a power of two; depth is capped at 8
+    CountMinSketch(size_t width, size_t depth);
+
+    // Count a word
+    void add(std::string_view word, uint32_t count = 1);
+
+    // Upper bound on how often a word was counted
+    uint32_t estimate(std::string_view word) const;
+
+    // Forget every count
+    void clear();
+};
+
+// Tracks the most frequent words of a stream with a fixed number of counters
+// (the Space-Saving algorithm).
+//
+// While there are free counters every word is counted exactly. Once they are
+// used up, a new word takes over the counter of the least frequent one and
+// inherits its count as an error bound, so any word seen more often than
+// total / capacity times is guaranteed to be kept. Words with equal counts
+// are ranked by their guaranteed count, count - error.
+class SpaceSaving {
+private:
+    // A monitored word
+    struct Counter {
+        std::string word;
+        uint32_t count = 0;             // Overestimates the true count by at most error
+        uint32_t error = 0;             // Count inherited on eviction
+    };
+
+    size_t capacity;
+    std::vector<Counter> heap;                          // Min-heap on count
+    std::unordered_map<std::string, size_t> positions;  // Word -> index in heap
+
+    // Restore heap order after a counter at index grew
+    void siftDown(size_t index);
+
+public:
+    explicit SpaceSaving(size_t capacity);
+
+    // Count a word
+    void add(const std::string& word, uint32_t count = 1);
+
+    // Monitored words with their counts, most frequent first; ties go to
+    // the word with the larger guaranteed count
+    std::vector<std::pair<std::string, int>> top(size_t count) const;
+
+    // Forget every count
+    void clear();
+};
+
+// Word frequencies of mood descriptions, overall and per calendar month, in
+// bounded memory.
+//
+// Every summary pairs a SpaceSaving table, which decides which words are
+// candidates for the top, with a CountMinSketch that tightens their counts.
+// Only the most recent months keep a summary of their own; older months
+// still count towards the overall one.
+class WordFrequencyTracker {
+private:
+    // Frequencies for one period
+    struct Summary {
+        CountMinSketch sketch;
+        SpaceSaving heavyHitters;
+
+        Summary(size_t width, size_t capacity);
+        void add(const std::string& word, uint32_t count);
+        std::vector<std::pair<std::string, int>> top(size_t count) const;
+    };
+
+    Summary overall;
+    std::map<long long, Summary> months;    // Keyed by the first day of the month
+
+public:
+    WordFrequencyTracker();
+
+    // Count a word used on a local day (see LocalDate.h)
+    void addWord(const std::string& word, long long day, int count = 1);
+
+    // Most frequent words ever, most frequent first, with estimated counts
+    std::vector<std::pair<std::string, int>> getTopWords(size_t count) const;
+
+    // Most frequent words in the month containing a day; empty if that
+    // month is too old to have its own summary
+    std::vector<std::pair<std::string, int>> getTopWordsForMonth(long long day, size_t count) const;
+
+    // Forget every count
+    void clear();
+};
+
+#endif // WORD_FREQUENCY_H
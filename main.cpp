@@ -1,5 +1,9 @@
 #include "MoodTracker.h"
 #include "ResourceMap.h"
+#include "Commands.h"
+#include "SentimentAnalyzer.h"
+#include "LocalDate.h"
+#include "HistorySync.h"
 #include <iostream>
 #include <string>
 #include <limits>
@@ -10,6 +14,8 @@
 #include <algorithm>
 #include <cctype>
 #include <random>
+#include <map>
+#include <future>
 
 namespace fs = std::filesystem;
 
@@ -22,14 +28,43 @@ void viewMoodStats(const MoodTracker& tracker);
 void displayResources(const ResourceMap& resources);
 void clearScreen();
 bool confirmAction(const std::string& message);
-void displayResourcesBasedOnMood(const MoodEntry& entry, const ResourceMap& resources);
+void displayResourcesBasedOnMood(const MoodEntry& entry, const MoodTracker& tracker, const ResourceMap& resources,
+                                 const std::vector<Resource>& alreadyShown = {});
 std::string formatTimestamp(const std::chrono::system_clock::time_point& timestamp);
 std::string getRandomEncouragement();
+std::string describeSentiment(double sentiment);
+void printRankedWords(const std::vector<std::pair<std::string, int>>& words);
 
-int main() {
-    // Initialize the mood tracker and resource map
+int main(int argc, char* argv[]) {
+    // Any arguments select a headless subcommand instead of the interactive menu
+    std::vector<std::string> args(argv + 1, argv + argc);
+    if (!args.empty()) {
+        return runCommand(args);
+    }
+    
+    // Initialize the mood tracker, resource map and sentiment analyzer
     MoodTracker tracker;
     ResourceMap resources;
+    SentimentAnalyzer sentiment;
+    
+    // Try to load a custom sentiment lexicon
+    std::string lexiconFile = "resources/sentiment_lexicon.json";
+    if (fs::exists(lexiconFile)) {
+        sentiment.loadLexiconFromFile(lexiconFile);
+    }
+    tracker.setSentimentAnalyzer(&sentiment);
+    
+    // Try to load custom alert rules
+    std::string alertRulesFile = "resources/alert_rules.json";
+    if (fs::exists(alertRulesFile)) {
+        tracker.loadAlertRules(alertRulesFile);
+    }
+    
+    // Try to load the retention policy for old entries
+    std::string retentionFile = "resources/retention.json";
+    if (fs::exists(retentionFile)) {
+        tracker.loadRetentionPolicy(retentionFile);
+    }
     
     // Create data directory if it doesn't exist
     std::string dataPath = "data";
@@ -39,8 +74,19 @@ int main() {
     
     // Try to load existing mood history
     std::string historyFile = dataPath + "/mood_history.json";
+    HistorySync historySync(historyFile);
     if (fs::exists(historyFile)) {
-        tracker.loadMoodHistory(historyFile);
+        if (!historySync.load(tracker)) {
+            // Saving over a history we couldn't read would lose it
+            std::cout << "Could not read " << historyFile << " or its rollups." << std::endl;
+            std::cout << "New entries will not be saved until the file is fixed." << std::endl;
+            std::cout << "Press Enter to continue...";
+            std::cin.get();
+        } else {
+            // Score descriptions, reusing the scores cached next to the history
+            // (only after a good load, so an empty tracker never replaces the cache)
+            tracker.rescoreSentiment(dataPath + "/mood_history.sentiment.json");
+        }
     }
     
     // Try to load custom resources
@@ -49,12 +95,30 @@ int main() {
         resources.loadResourcesFromFile(resourceFile);
     }
     
+    // Save new entries and pick up entries logged elsewhere in the background
+    historySync.start();
+    
+    // Roll up expired entries in the background while the menu is up
+    std::future<CompactionResult> compaction = tracker.startCompaction();
+    
     // Display welcome message
     displayWelcomeMessage();
     
     // Main program loop
     bool running = true;
     while (running) {
+        // Apply the compaction once it has finished
+        if (compaction.valid() &&
+            compaction.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            CompactionResult result = compaction.get();
+            if (result.rawEntriesCompacted > 0 && tracker.applyCompaction(result)) {
+                historySync.rewrite(tracker);
+            }
+        }
+        
+        // Pick up entries logged from the command line meanwhile
+        historySync.importAppended(tracker);
+        
         displayMenu();
         
         int choice;
@@ -78,7 +142,9 @@ int main() {
                 addNewMoodEntry(tracker, resources);
                 
                 // Save after each entry
-                tracker.saveMoodHistory(historyFile);
+                if (!historySync.append(tracker.getLatestMood())) {
+                    std::cout << "This entry could not be saved to " << historyFile << "." << std::endl;
+                }
                 break;
             case 2:
                 // View mood history
@@ -105,6 +171,11 @@ int main() {
         }
     }
     
+    if (!historySync.stop()) {
+        std::cout << "Some entries could not be saved to " << historyFile << "." << std::endl;
+        return 1;
+    }
+    
     return 0;
 }
 
@@ -163,8 +234,8 @@ void addNewMoodEntry(MoodTracker& tracker, const ResourceMap& resources) {
     std::cout << "Describe how you're feeling in a few words: ";
     std::getline(std::cin, description);
     
-    // Add to tracker
-    tracker.addMoodEntry(score, description);
+    // Add to tracker, collecting any alerts this entry triggered
+    auto alerts = tracker.addMoodEntry(score, description);
     
     // Get the entry we just added
     MoodEntry latestEntry = tracker.getLatestMood();
@@ -174,15 +245,39 @@ void addNewMoodEntry(MoodTracker& tracker, const ResourceMap& resources) {
     std::cout << "Mood logged successfully at " << formatTimestamp(latestEntry.timestamp) << std::endl;
     std::cout << "Score: " << latestEntry.score << "/10" << std::endl;
     std::cout << "Description: " << latestEntry.description << std::endl;
+    std::cout << "Tone: " << describeSentiment(latestEntry.sentiment) << std::endl;
     std::cout << std::endl;
     
     // Show encouragement for all entries
     std::cout << getRandomEncouragement() << std::endl;
     std::cout << std::endl;
     
-    // If mood score is low or has negative words, suggest resources
-    if (score <= 4) {
-        displayResourcesBasedOnMood(latestEntry, resources);
+    // Point out any worrying patterns
+    bool crisis = false;
+    for (const auto& alert : alerts) {
+        std::cout << "Notice: " << alert.message << std::endl;
+        crisis = crisis || alert.crisis;
+    }
+    if (!alerts.empty()) {
+        std::cout << std::endl;
+    }
+    
+    // Crisis resources come before anything else
+    std::vector<Resource> crisisResources;
+    if (crisis) {
+        crisisResources = resources.getResourcesForScore(1);
+        std::cout << "If you need support right now, please reach out:" << std::endl;
+        for (const auto& resource : crisisResources) {
+            std::cout << "  * " << resource.title << std::endl;
+            std::cout << "    " << resource.description << std::endl;
+            std::cout << "    URL: " << resource.url << std::endl;
+        }
+        std::cout << std::endl;
+    }
+    
+    // If mood score is low, has negative words or raised an alert, suggest resources
+    if (ResourceMap::suggestsResources(latestEntry) || !alerts.empty()) {
+        displayResourcesBasedOnMood(latestEntry, tracker, resources, crisisResources);
     }
     
     std::cout << "Press Enter to continue...";
@@ -211,6 +306,7 @@ void viewMoodHistory(const MoodTracker& tracker) {
             std::cout << "Date: " << formatTimestamp(entry.timestamp) << std::endl;
             std::cout << "Score: " << entry.score << "/10" << std::endl;
             std::cout << "Description: " << entry.description << std::endl;
+            std::cout << "Tone: " << describeSentiment(entry.sentiment) << std::endl;
             std::cout << "---------------------------------------------" << std::endl;
         }
         
@@ -232,55 +328,51 @@ void viewMoodStats(const MoodTracker& tracker) {
     std::cout << "              MOOD STATISTICS                 " << std::endl;
     std::cout << "==============================================" << std::endl;
     
-    const auto& history = tracker.getMoodHistory();
-    
-    if (history.empty()) {
+    if (tracker.getTotalEntryCount() == 0) {
         std::cout << "No mood entries found. Try logging your mood first." << std::endl;
     } else {
-        // Calculate average score
-        double average = tracker.getAverageMoodScore();
+        // Summarize everything, including entries kept only as rollups
+        auto summary = tracker.summarizeAll();
         
-        // Find highest and lowest scores
-        int highest = 0, lowest = 10;
-        std::chrono::system_clock::time_point highestDate, lowestDate;
+        // Display statistics
+        std::cout << "Total entries: " << summary.count << std::endl;
+        std::cout << "Average mood score: " << std::fixed << std::setprecision(1) << summary.average << "/10" << std::endl;
+        std::cout << "Highest mood: " << summary.highest << "/10 on " << formatTimestamp(summary.highestTime) << std::endl;
+        std::cout << "Lowest mood: " << summary.lowest << "/10 on " << formatTimestamp(summary.lowestTime) << std::endl;
         
-        for (const auto& entry : history) {
-            if (entry.score > highest) {
-                highest = entry.score;
-                highestDate = entry.timestamp;
-            }
-            if (entry.score < lowest) {
-                lowest = entry.score;
-                lowestDate = entry.timestamp;
+        // Chart weekly averages for the last 8 weeks
+        auto now = std::chrono::system_clock::now();
+        auto days = tracker.getDailySummaries(now - std::chrono::hours(24 * 7 * 8), now);
+        std::map<long long, std::pair<int, long long>> weeks;
+        for (const auto& day : days) {
+            auto& week = weeks[startOfWeek(day.startDay)];
+            week.first += day.count;
+            week.second += day.sum;
+        }
+        if (!weeks.empty()) {
+            std::cout << std::endl;
+            std::cout << "Weekly average (last 8 weeks):" << std::endl;
+            for (const auto& [weekStart, totals] : weeks) {
+                double weekAverage = static_cast<double>(totals.second) / totals.first;
+                std::cout << "  " << formatDayNumber(weekStart) << "  "
+                          << std::string(static_cast<size_t>(weekAverage + 0.5), '#')
+                          << " " << weekAverage << std::endl;
             }
         }
         
-        // Display statistics
-        std::cout << "Total entries: " << history.size() << std::endl;
-        std::cout << "Average mood score: " << std::fixed << std::setprecision(1) << average << "/10" << std::endl;
-        std::cout << "Highest mood: " << highest << "/10 on " << formatTimestamp(highestDate) << std::endl;
-        std::cout << "Lowest mood: " << lowest << "/10 on " << formatTimestamp(lowestDate) << std::endl;
-        
-        // Display unique mood words if there are any
-        const auto& uniqueWords = tracker.getUniqueMoodWords();
-        if (!uniqueWords.empty()) {
+        // Display the most used mood words, overall and this month
+        auto topWords = tracker.getTopMoodWords(10);
+        if (!topWords.empty()) {
             std::cout << std::endl;
-            std::cout << "Words you've used to describe your moods:" << std::endl;
+            std::cout << "Words you use most to describe your moods:" << std::endl;
+            printRankedWords(topWords);
             
-            // Print in a nice format
-            int count = 0;
-            for (const auto& word : uniqueWords) {
-                std::cout << word;
-                if (++count < uniqueWords.size()) {
-                    std::cout << ", ";
-                }
-                
-                // Add newline every 8 words for readability
-                if (count % 8 == 0) {
-                    std::cout << std::endl;
-                }
+            auto monthWords = tracker.getTopMoodWordsForMonth(now, 5);
+            if (!monthWords.empty()) {
+                std::cout << std::endl;
+                std::cout << "This month:" << std::endl;
+                printRankedWords(monthWords);
             }
-            std::cout << std::endl;
         }
     }
     
@@ -345,49 +437,37 @@ bool confirmAction(const std::string& message) {
 }
 
 // Function to display resources based on mood
-void displayResourcesBasedOnMood(const MoodEntry& entry, const ResourceMap& resources) {
+void displayResourcesBasedOnMood(const MoodEntry& entry, const MoodTracker& tracker, const ResourceMap& resources,
+                                 const std::vector<Resource>& alreadyShown) {
     std::cout << "Based on your mood, here are some resources that might help:" << std::endl;
     std::cout << std::endl;
     
-    // Check for score-based resources first
-    auto scoreResources = resources.getResourcesForScore(entry.score);
-    
-    // Extract words from the description for mood-based resources
-    std::istringstream iss(entry.description);
-    std::string word;
-    std::vector<Resource> moodResources;
-    
-    while (iss >> word) {
-        // Convert to lowercase
-        std::transform(word.begin(), word.end(), word.begin(),
-                      [](unsigned char c){ return std::tolower(c); });
-        
-        // Remove punctuation
-        word.erase(std::remove_if(word.begin(), word.end(),
-                                 [](unsigned char c){ return std::ispunct(c); }),
-                  word.end());
-        
-        // Get resources for this word
-        auto wordResources = resources.getResourcesForMood(word);
-        
-        // Add to our collection
-        moodResources.insert(moodResources.end(), wordResources.begin(), wordResources.end());
+    // Rank resources by relevance, favouring ones not shown recently.
+    // Display only a few resources to avoid overwhelming
+    auto recommendations = resources.recommendResources(entry, tracker.getMoodHistory(),
+                                                        ResourceMap::kShownPerEntry + alreadyShown.size());
+    
+    // Skip anything already displayed above
+    recommendations.erase(std::remove_if(recommendations.begin(), recommendations.end(),
+                                         [&alreadyShown](const RecommendedResource& recommendation) {
+                                             return std::any_of(alreadyShown.begin(), alreadyShown.end(),
+                                                                [&recommendation](const Resource& shown) {
+                                                                    return shown.url == recommendation.resource.url;
+                                                                });
+                                         }),
+                          recommendations.end());
+    if (recommendations.size() > ResourceMap::kShownPerEntry) {
+        recommendations.erase(recommendations.begin() + ResourceMap::kShownPerEntry, recommendations.end());
     }
     
-    // Combine both sets of resources
-    std::vector<Resource> allResources = scoreResources;
-    allResources.insert(allResources.end(), moodResources.begin(), moodResources.end());
-    
     // Display resources or a message if none found
-    if (allResources.empty()) {
+    if (recommendations.empty()) {
         std::cout << "No specific resources found for your current mood." << std::endl;
         std::cout << "You can browse all available resources from the main menu." << std::endl;
     } else {
-        // Display up to 3 resources to avoid overwhelming
         int count = 0;
-        for (const auto& resource : allResources) {
-            if (count >= 3) break;
-            
+        for (const auto& recommendation : recommendations) {
+            const auto& resource = recommendation.resource;
             std::cout << count + 1 << ". " << resource.title << std::endl;
             std::cout << "   " << resource.description << std::endl;
             std::cout << "   URL: " << resource.url << std::endl;
@@ -395,17 +475,16 @@ void displayResourcesBasedOnMood(const MoodEntry& entry, const ResourceMap& reso
             count++;
         }
         
-        if (allResources.size() > 3) {
-            std::cout << "... and " << allResources.size() - 3 << " more resources available from the main menu." << std::endl;
-        }
+        std::cout << "More resources are available from the main menu." << std::endl;
     }
 }
 
 // Function to format timestamp for display
 std::string formatTimestamp(const std::chrono::system_clock::time_point& timestamp) {
     auto timeT = std::chrono::system_clock::to_time_t(timestamp);
+    std::tm local = toLocalTime(timeT);
     std::stringstream ss;
-    ss << std::put_time(std::localtime(&timeT), "%Y-%m-%d %H:%M:%S");
+    ss << std::put_time(&local, "%Y-%m-%d %H:%M:%S");
     return ss.str();
 }
 
@@ -431,3 +510,20 @@ std::string getRandomEncouragement() {
     
     return encouragements[distrib(gen)];
 }
+
+// Function to describe a sentiment score in words
+std::string describeSentiment(double sentiment) {
+    if (sentiment <= -0.6) return "very negative";
+    if (sentiment <= -0.2) return "negative";
+    if (sentiment < 0.2) return "neutral";
+    if (sentiment < 0.6) return "positive";
+    return "very positive";
+}
+
+// Function to print words with their counts as a numbered list
+void printRankedWords(const std::vector<std::pair<std::string, int>>& words) {
+    for (size_t i = 0; i < words.size(); ++i) {
+        std::cout << std::setw(4) << i + 1 << ". " << std::left << std::setw(20) << words[i].first
+                  << std::right << words[i].second << (words[i].second == 1 ? " time" : " times") << std::endl;
+    }
+}
@@ -0,0 +1,152 @@
+// Stress test for ConcurrentMoodTracker: producers append while readers take
+// snapshots; checks that no entry is lost, duplicated or torn, and that every
+// snapshot's aggregates match exactly the entries it contains.
+
+#include "ConcurrentMoodTracker.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int kProducers = 8;
+constexpr int kReaders = 3;
+constexpr int kEntriesPerProducer = 5000;
+
+std::atomic<int> failures{0};
+
+// Report a failed check without stopping the other threads
+void check(bool condition, const std::string& message) {
+    if (!condition) {
+        if (failures.fetch_add(1) < 10) {
+            std::cerr << "FAILED: " << message << std::endl;
+        }
+    }
+}
+
+// Score and description are both derived from (producer, index), so a torn
+// entry shows up as a mismatch between them
+int scoreFor(int producer, int index) {
+    return 1 + (producer * 7 + index) % 10;
+}
+
+std::string descriptionFor(int producer, int index) {
+    return "producer " + std::to_string(producer) + " entry " + std::to_string(index);
+}
+
+// Recover (producer, index) from a description; false if it is malformed
+bool parseDescription(const std::string& description, int& producer, int& index) {
+    return std::sscanf(description.c_str(), "producer %d entry %d", &producer, &index) == 2 &&
+           descriptionFor(producer, index) == description;
+}
+
+// Check one snapshot against itself
+void checkSnapshot(const MoodSnapshot& snapshot, std::vector<int>& lastSeen) {
+    check(snapshot.count == snapshot.entries.size(), "snapshot count matches its entries");
+
+    long long sum = 0;
+    int lowest = 0;
+    int highest = 0;
+    std::vector<int> next(kProducers, 0);
+    for (size_t i = 0; i < snapshot.entries.size(); ++i) {
+        const MoodEntry& entry = snapshot.entries[i];
+        int producer = 0;
+        int index = 0;
+        if (!parseDescription(entry.description, producer, index) ||
+            producer < 0 || producer >= kProducers) {
+            check(false, "entry is well formed: " + entry.description);
+            continue;
+        }
+        check(entry.score == scoreFor(producer, index), "entry is not torn: " + entry.description);
+
+        // Each producer's entries are published in the order it added them
+        check(index == next[producer], "producer order kept: " + entry.description);
+        next[producer] = index + 1;
+
+        sum += entry.score;
+        lowest = i == 0 ? entry.score : std::min(lowest, entry.score);
+        highest = i == 0 ? entry.score : std::max(highest, entry.score);
+    }
+
+    if (snapshot.count > 0) {
+        double average = static_cast<double>(sum) / snapshot.count;
+        check(snapshot.averageScore == average, "snapshot average matches its entries");
+        check(snapshot.lowestScore == lowest, "snapshot lowest matches its entries");
+        check(snapshot.highestScore == highest, "snapshot highest matches its entries");
+    }
+
+    // Snapshots only ever grow
+    for (int p = 0; p < kProducers; ++p) {
+        check(next[p] >= lastSeen[p], "snapshots never lose entries");
+        lastSeen[p] = next[p];
+    }
+}
+
+} // namespace
+
+int main() {
+    ConcurrentMoodTracker tracker;
+    std::atomic<int> producersDone{0};
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < kProducers; ++p) {
+        threads.emplace_back([&tracker, &producersDone, p] {
+            for (int i = 0; i < kEntriesPerProducer; ++i) {
+                tracker.addMoodEntry(MoodEntry(scoreFor(p, i), descriptionFor(p, i)));
+
+                // Give the readers a chance to overlap with every stage of the run
+                if (i % 64 == 0) {
+                    std::this_thread::yield();
+                }
+            }
+            producersDone.fetch_add(1);
+        });
+    }
+
+    std::atomic<long> snapshotsTaken{0};
+    for (int r = 0; r < kReaders; ++r) {
+        threads.emplace_back([&tracker, &producersDone, &snapshotsTaken] {
+            std::vector<int> lastSeen(kProducers, 0);
+            size_t lastSize = 0;
+            while (producersDone.load() < kProducers) {
+                size_t size = tracker.size();
+                check(size >= lastSize, "size never shrinks");
+                lastSize = size;
+
+                checkSnapshot(tracker.snapshot(), lastSeen);
+                snapshotsTaken.fetch_add(1);
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // Every entry arrives exactly once
+    MoodSnapshot complete = tracker.snapshot();
+    std::vector<int> lastSeen(kProducers, 0);
+    checkSnapshot(complete, lastSeen);
+    check(complete.count == static_cast<size_t>(kProducers) * kEntriesPerProducer, "no entries lost");
+    for (int p = 0; p < kProducers; ++p) {
+        check(lastSeen[p] == kEntriesPerProducer, "every producer's entries arrived");
+    }
+
+    // Exporting in two steps adds every entry once
+    MoodTracker exported;
+    size_t next = tracker.exportTo(exported, 0);
+    check(tracker.exportTo(exported, next) == next, "export resumes where it stopped");
+    check(exported.getMoodHistory().size() == complete.count, "export copies every entry");
+    check(tracker.entriesSince(complete.count - 5).size() == 5, "entriesSince returns the tail");
+
+    if (failures.load() > 0) {
+        std::cerr << failures.load() << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "OK: " << complete.count << " entries, " << snapshotsTaken.load() << " snapshots" << std::endl;
+    return 0;
+}
@@ -0,0 +1,100 @@
+// Benchmark for the Tokenizer: splits 100,000 generated mood descriptions
+// with the stream-based splitting it replaced, with extractWords, and with one
+// reused Tokenizer. Built only with -DEMPATHY_BUILD_BENCHMARKS=ON.
+
+#include "Tokenizer.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr size_t kDescriptions = 100000;
+
+// The splitting used before the Tokenizer: whitespace-separated tokens,
+// lowercased, with ASCII punctuation removed
+std::vector<std::string> streamWords(const std::string& description) {
+    std::vector<std::string> words;
+    std::istringstream iss(description);
+    std::string word;
+    while (iss >> word) {
+        std::transform(word.begin(), word.end(), word.begin(),
+                       [](unsigned char c) { return std::tolower(c); });
+        word.erase(std::remove_if(word.begin(), word.end(),
+                                  [](unsigned char c) { return std::ispunct(c); }),
+                   word.end());
+        if (!word.empty()) {
+            words.push_back(word);
+        }
+    }
+    return words;
+}
+
+// Descriptions of 3 to 20 words, mostly ASCII with some accented and
+// non-Latin words, like a real history
+std::vector<std::string> makeDescriptions(bool asciiOnly) {
+    const std::vector<std::string> ascii = {
+        "tired", "happy", "Anxious", "calm", "not", "really", "good", "STRESSED", "about",
+        "work", "today", "I'm", "feeling", "a", "bit", "overwhelmed,", "but", "ok.", "sleep",
+        "self-care", "family", "grateful!", "lonely", "motivated", "exhausted...", "sad"
+    };
+    const std::vector<std::string> other = {
+        "müde", "ÜBERFORDERT", "café", "ΧΑΡΟΥΜΕΝΟΣ", "устал", "don’t", "naïve", "grüße"
+    };
+
+    std::mt19937 random(42);
+    std::vector<std::string> descriptions;
+    descriptions.reserve(kDescriptions);
+    for (size_t i = 0; i < kDescriptions; ++i) {
+        std::string description;
+        size_t words = 3 + random() % 18;
+        for (size_t w = 0; w < words; ++w) {
+            if (w > 0) {
+                description += ' ';
+            }
+            bool useOther = !asciiOnly && random() % 10 == 0;
+            description += useOther ? other[random() % other.size()] : ascii[random() % ascii.size()];
+        }
+        descriptions.push_back(description);
+    }
+    return descriptions;
+}
+
+// Run a splitter over every description and report the time and word count
+template <typename Split>
+void measure(const std::string& name, const std::vector<std::string>& descriptions, Split split) {
+    auto start = std::chrono::steady_clock::now();
+    size_t words = 0;
+    for (const auto& description : descriptions) {
+        words += split(description);
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+    std::cout << "  " << name << ": " << elapsed.count() << " ms (" << words << " words)" << std::endl;
+}
+
+} // namespace
+
+int main() {
+    for (bool asciiOnly : {true, false}) {
+        std::vector<std::string> descriptions = makeDescriptions(asciiOnly);
+        std::cout << kDescriptions << (asciiOnly ? " ASCII" : " mixed UTF-8") << " descriptions:" << std::endl;
+
+        measure("stream splitting", descriptions,
+                [](const std::string& text) { return streamWords(text).size(); });
+        measure("extractWords", descriptions,
+                [](const std::string& text) { return extractWords(text).size(); });
+
+        Tokenizer tokenizer;
+        measure("reused Tokenizer", descriptions, [&tokenizer](const std::string& text) {
+            tokenizer.tokenize(text);
+            return tokenizer.wordCount();
+        });
+    }
+    return 0;
+}
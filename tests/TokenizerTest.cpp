@@ -0,0 +1,159 @@
+// Tests for the Tokenizer: a multilingual corpus with the expected words, and
+// random ASCII text checked against a plain byte-by-byte reference, which
+// covers the 16-byte SSE2 blocks and their boundaries.
+
+#include "Tokenizer.h"
+#include <cctype>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+// Words joined by spaces, with "|" after a word that ends a clause
+std::string describe(const Tokenizer& tokenizer) {
+    std::string result;
+    for (size_t i = 0; i < tokenizer.wordCount(); ++i) {
+        if (i > 0) {
+            result += ' ';
+        }
+        result += tokenizer.word(i);
+        if (tokenizer.endsClause(i)) {
+            result += '|';
+        }
+    }
+    return result;
+}
+
+void expectEqual(const std::string& actual, const std::string& expected, const std::string& input) {
+    if (actual != expected) {
+        if (++failures <= 10) {
+            std::cerr << "FAILED: \"" << input << "\"" << std::endl;
+            std::cerr << "  expected: " << expected << std::endl;
+            std::cerr << "  actual:   " << actual << std::endl;
+        }
+    }
+}
+
+// The same rules spelled out for ASCII: a word is a run of letters, digits
+// and apostrophes without leading or trailing apostrophes, and . , ; : ! ?
+// after a word end its clause
+std::string referenceTokenize(const std::string& text) {
+    std::vector<std::string> words;
+    std::vector<bool> endsClause;
+    std::string current;
+
+    auto finishWord = [&]() {
+        size_t first = current.find_first_not_of('\'');
+        size_t last = current.find_last_not_of('\'');
+        if (first != std::string::npos) {
+            words.push_back(current.substr(first, last - first + 1));
+            endsClause.push_back(false);
+        }
+        current.clear();
+    };
+
+    for (char c : text) {
+        unsigned char byte = static_cast<unsigned char>(c);
+        if (std::isalnum(byte) || c == '\'') {
+            current += static_cast<char>(std::tolower(byte));
+            continue;
+        }
+        finishWord();
+        if (std::string(".,;:!?").find(c) != std::string::npos && !words.empty()) {
+            endsClause.back() = true;
+        }
+    }
+    finishWord();
+
+    std::string result;
+    for (size_t i = 0; i < words.size(); ++i) {
+        if (i > 0) {
+            result += ' ';
+        }
+        result += words[i];
+        if (endsClause[i]) {
+            result += '|';
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+int main() {
+    // Input and the expected words
+    const std::vector<std::pair<std::string, std::string>> corpus = {
+        // Plain ASCII, clause marks and apostrophes
+        {"I'm 'not' happy, really", "i'm not happy| really"},
+        {"one. two, three; four: five! six? seven", "one| two| three| four| five| six| seven"},
+        {"self-care and well_being", "self care and well being"},
+        {"tired...   so tired!!!", "tired| so tired|"},
+        // German, including ß and capital ẞ
+        {"Müde, ÜBERFORDERT und traurig.", "müde| überfordert und traurig|"},
+        {"STRAẞE Maß ẞ", "strasse mass ss"},
+        // French and other accented Latin
+        {"Naïve CAFÉ, très ÉPUISÉ", "naïve café| très épuisé"},
+        // Greek, final sigma folds like sigma
+        {"Ελληνικά ΣΟΦΟΣ σοφος", "ελληνικά σοφοσ σοφοσ"},
+        // Cyrillic
+        {"ПРИВЕТ мир, ЁЛКА Їжак", "привет мир| ёлка їжак"},
+        // U+2019 right single quotation mark works as an apostrophe
+        {"don’t worry, it’s fine", "don't worry| it's fine"},
+        // Non-ASCII punctuation and spaces (here U+00A0 and U+200B) separate words;
+        // ellipsis and CJK marks end clauses
+        {"seven… eight。nine、ten — eleven", "seven| eight| nine| ten eleven"},
+        {"tired\xc2\xa0sad\xe2\x80\x8b" "calm", "tired sad calm"},
+        // Emoji separate words
+        {"\U0001F600happy\U0001F600sad", "happy sad"},
+        // Combining marks stay inside the word
+        {"ab\xcc\x81" "c", "ab\xcc\x81" "c"},
+        // Fullwidth letters fold but are not normalized to ASCII
+        {"ＡＢＣ", "ａｂｃ"},
+        // Invalid UTF-8 separates words: stray, truncated, overlong and surrogate sequences
+        {"abc\xff\xfe" "def", "abc def"},
+        {"word\xc3", "word"},
+        {"a\xc0\xaf" "b", "a b"},
+        {"x\xed\xa0\x80" "y", "x y"},
+        {"ok\xf8\x88\x80\x80\x80" "ok", "ok ok"},
+        // Words spanning 16-byte blocks, and non-ASCII right after a block
+        {"abcdefghijklmnop-qrstuvwxyzABCDEFGHIJ,KLMNOPQRSTUVWXYZ\xc3\x84q",
+         "abcdefghijklmnop qrstuvwxyzabcdefghij| klmnopqrstuvwxyzäq"},
+        {"", ""},
+        {" ,.; ", ""},
+    };
+
+    // One instance for the whole corpus, so leftover state would show up
+    Tokenizer tokenizer;
+    for (const auto& [input, expected] : corpus) {
+        tokenizer.tokenize(input);
+        expectEqual(describe(tokenizer), expected, input);
+    }
+
+    // extractWords and foldCase agree with the tokenizer
+    std::vector<std::string> words = extractWords("Müde, ΣΟΦΟΣ");
+    expectEqual(words.size() == 2 ? words[0] + " " + words[1] : "", "müde σοφοσ", "extractWords");
+    expectEqual(foldCase("HAPPY Ünïcode STRAẞE"), "happy ünïcode strasse", "foldCase");
+
+    // Random ASCII against the reference, with lengths around the block size
+    std::mt19937 random(12345);
+    const std::string alphabet = "abcXYZ09'  .,;:!?-_/()\"\t\n";
+    for (int i = 0; i < 20000; ++i) {
+        std::string text(random() % 70, ' ');
+        for (auto& c : text) {
+            c = alphabet[random() % alphabet.size()];
+        }
+        tokenizer.tokenize(text);
+        expectEqual(describe(tokenizer), referenceTokenize(text), text);
+    }
+
+    if (failures > 0) {
+        std::cerr << failures << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "OK" << std::endl;
+    return 0;
+}